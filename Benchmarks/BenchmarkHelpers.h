@@ -0,0 +1,44 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file BenchmarkHelpers.h
+* @author CS Islay
+* @brief Throughput counters and note periods shared by the benchmarks.
+*****************************************************************************/
+
+#ifndef BENCHMARK_HELPERS_H
+#define BENCHMARK_HELPERS_H
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+// Reports the throughput of a benchmark that processes samplesPerIteration samples each iteration,
+// as samples per second (items_per_second) and the time taken per sample
+inline void setSampleCounters(benchmark::State& state, const int64_t samplesPerIteration)
+{
+    state.SetItemsProcessed(int64_t(state.iterations()) * samplesPerIteration);
+    state.counters["time/sample"] = benchmark::Counter(double(samplesPerIteration),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+// The period of a MIDI note in samples
+inline float notePeriod(const float noteNumber, const float sampleRate)
+{
+    return sampleRate / (std::exp2((noteNumber - 69.0f) / 12.0f) * 440.0f);
+}
+
+#endif //BENCHMARK_HELPERS_H
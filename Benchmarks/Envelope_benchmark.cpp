@@ -0,0 +1,108 @@
+#pragma once
+#include "BenchmarkHelpers.h"
+#include "ADSREnvelope.h"
+#include "Noise.h"
+#include "OutputSafety.h"
+#include <vector>
+
+static void BM_ADSREnvelope_nextValue(benchmark::State& state)
+{
+    ADSREnvelope env;
+    env.setSampleRate(48000.0f);
+    env.setAttack(10.0f);
+    env.setDecay(50.0f);
+    env.setSustain(50.0f);
+    env.setRelease(50.0f);
+    env.attack();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(env.nextValue());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_ADSREnvelope_nextValue);
+
+// Starts the attack again whenever the envelope goes silent, so every stage is covered
+static void BM_ADSREnvelope_renderBlock(benchmark::State& state)
+{
+    ADSREnvelope env;
+    env.setSampleRate(48000.0f);
+    env.setAttack(10.0f);
+    env.setDecay(50.0f);
+    env.setSustain(0.0f);
+    env.setRelease(50.0f);
+    env.attack();
+    std::vector<float> output(size_t(state.range(0)));
+    for (auto _ : state) {
+        if (env.renderBlock(output.data(), int(output.size())) < int(output.size())) {
+            env.attack();
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, state.range(0));
+}
+BENCHMARK(BM_ADSREnvelope_renderBlock)->Arg(32)->Arg(512);
+
+static void BM_Noise_nextValue(benchmark::State& state)
+{
+    Noise noise;
+    noise.reset();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(noise.nextValue());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_Noise_nextValue);
+
+// Argument: 0 for white noise, 1 for pink
+static void BM_Noise_fill(benchmark::State& state)
+{
+    Noise noise;
+    noise.reset();
+    noise.setColour(state.range(0) == 0 ? NoiseColour::White : NoiseColour::Pink);
+    std::vector<float> buffer(512);
+    for (auto _ : state) {
+        noise.fill(buffer.data(), int(buffer.size()));
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, int64_t(buffer.size()));
+}
+BENCHMARK(BM_Noise_fill)->Arg(0)->Arg(1);
+
+// A stream for each of eight voices. Argument: 0 for white noise, 1 for pink
+static void BM_NoiseLanes_fill(benchmark::State& state)
+{
+    NoiseLanes<8> noise;
+    noise.reset();
+    noise.setColour(state.range(0) == 0 ? NoiseColour::White : NoiseColour::Pink);
+    std::vector<float> buffer(512 * 8);
+    for (auto _ : state) {
+        noise.fill(buffer.data(), 512);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, int64_t(buffer.size()));
+}
+BENCHMARK(BM_NoiseLanes_fill)->Arg(0)->Arg(1);
+
+static void BM_OutputSafety_process(benchmark::State& state)
+{
+    // a stereo block of ordinary audio, so every sample is checked and nothing is muted
+    Noise noise;
+    noise.reset();
+    std::vector<float> left(size_t(state.range(0)));
+    std::vector<float> right(size_t(state.range(0)));
+    for (size_t i = 0; i < left.size(); i++) {
+        left[i] = 0.5f * noise.nextValue();
+        right[i] = 0.5f * noise.nextValue();
+    }
+    float* channels[2] = { left.data(), right.data() };
+    OutputSafety safety;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(safety.process(channels, 2, int(left.size())));
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, state.range(0));
+}
+BENCHMARK(BM_OutputSafety_process)->Arg(32)->Arg(512);
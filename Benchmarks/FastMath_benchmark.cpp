@@ -0,0 +1,114 @@
+#pragma once
+#include "BenchmarkHelpers.h"
+#include "FastMath.h"
+#include <cmath>
+#include <vector>
+
+using FastMath::Precision;
+
+namespace
+{
+    constexpr int MATH_BLOCK_SIZE = 512;
+
+    using BlockFunction = void (*)(const float* input, float* output, int count);
+
+    // Times one call of process on a block of inputs spread over [from, to]
+    void benchmarkBlock(benchmark::State& state, const float from, const float to, const BlockFunction process)
+    {
+        std::vector<float> input(MATH_BLOCK_SIZE), output(MATH_BLOCK_SIZE);
+        for (size_t i = 0; i < input.size(); ++i) { input[i] = from + (to - from) * float(i) / float(MATH_BLOCK_SIZE); }
+        for (auto _ : state) {
+            process(input.data(), output.data(), MATH_BLOCK_SIZE);
+            benchmark::DoNotOptimize(output.data());
+            benchmark::ClobberMemory();
+        }
+        setSampleCounters(state, MATH_BLOCK_SIZE);
+    }
+
+    // The same block through libm, a call per sample
+    template <float (*Function)(float)>
+    void libmBlock(const float* input, float* output, const int count)
+    {
+        for (int i = 0; i < count; ++i) { output[i] = Function(input[i]); }
+    }
+}
+
+// The LFO and pan range, a few turns either way
+static void BM_Math_sinLibm(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, libmBlock<std::sin>);
+}
+BENCHMARK(BM_Math_sinLibm);
+
+static void BM_Math_sinHigh(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, FastMath::sin<Precision::High>);
+}
+BENCHMARK(BM_Math_sinHigh);
+
+static void BM_Math_sinLow(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, FastMath::sin<Precision::Low>);
+}
+BENCHMARK(BM_Math_sinLow);
+
+static void BM_Math_expLibm(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, libmBlock<std::exp>);
+}
+BENCHMARK(BM_Math_expLibm);
+
+static void BM_Math_expHigh(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, FastMath::exp<Precision::High>);
+}
+BENCHMARK(BM_Math_expHigh);
+
+static void BM_Math_expLow(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, FastMath::exp<Precision::Low>);
+}
+BENCHMARK(BM_Math_expLow);
+
+static void BM_Math_exp2Libm(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, libmBlock<std::exp2>);
+}
+BENCHMARK(BM_Math_exp2Libm);
+
+static void BM_Math_exp2High(benchmark::State& state)
+{
+    benchmarkBlock(state, -20.0f, 20.0f, FastMath::exp2<Precision::High>);
+}
+BENCHMARK(BM_Math_exp2High);
+
+// The filter's prewarping range, up to 0.49 pi
+static void BM_Math_tanLibm(benchmark::State& state)
+{
+    benchmarkBlock(state, 0.0f, 1.5f, libmBlock<std::tan>);
+}
+BENCHMARK(BM_Math_tanLibm);
+
+static void BM_Math_tanHigh(benchmark::State& state)
+{
+    benchmarkBlock(state, 0.0f, 1.5f, FastMath::tan<Precision::High>);
+}
+BENCHMARK(BM_Math_tanHigh);
+
+static void BM_Math_tanhLibm(benchmark::State& state)
+{
+    benchmarkBlock(state, -4.0f, 4.0f, libmBlock<std::tanh>);
+}
+BENCHMARK(BM_Math_tanhLibm);
+
+static void BM_Math_tanhHigh(benchmark::State& state)
+{
+    benchmarkBlock(state, -4.0f, 4.0f, FastMath::tanh<Precision::High>);
+}
+BENCHMARK(BM_Math_tanhHigh);
+
+static void BM_Math_tanhLow(benchmark::State& state)
+{
+    benchmarkBlock(state, -4.0f, 4.0f, FastMath::tanh<Precision::Low>);
+}
+BENCHMARK(BM_Math_tanhLow);
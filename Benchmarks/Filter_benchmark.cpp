@@ -0,0 +1,153 @@
+#pragma once
+#include "BenchmarkHelpers.h"
+#include "FilterLanes.h"
+#include "HalfBandDecimator.h"
+#include "jx11_Filter.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    jx11_Filter setupFilter()
+    {
+        jx11_Filter filter;
+        filter.reset();
+        filter.setSampleRate(48000.0f);
+        filter.updateCoefficients(1000.0f, 0.707f);
+        return filter;
+    }
+}
+
+static void BM_Filter_render(benchmark::State& state)
+{
+    auto filter = setupFilter();
+    float input = 0.5f;
+    for (auto _ : state) {
+        input = -input;
+        benchmark::DoNotOptimize(filter.render(input));
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_Filter_render);
+
+static void BM_Filter_renderBlock(benchmark::State& state)
+{
+    auto filter = setupFilter();
+    // a square wave, so that the filter state doesn't decay into denormals
+    std::vector<float> input(size_t(state.range(0)));
+    for (size_t i = 0; i < input.size(); ++i) { input[i] = (i & 16) ? 0.5f : -0.5f; }
+    std::vector<float> buffer(input.size());
+    for (auto _ : state) {
+        std::copy(input.begin(), input.end(), buffer.begin());
+        filter.renderBlock(buffer.data(), int(buffer.size()));
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, state.range(0));
+}
+BENCHMARK(BM_Filter_renderBlock)->Arg(32)->Arg(512);
+
+// A new cutoff every time, so the coefficients are always recalculated
+static void BM_Filter_updateCoefficients(benchmark::State& state)
+{
+    auto filter = setupFilter();
+    float cutoff = 1000.0f;
+    for (auto _ : state) {
+        cutoff = (cutoff > 10000.0f) ? 1000.0f : cutoff * 1.01f;
+        filter.updateCoefficients(cutoff, 0.707f);
+        benchmark::DoNotOptimize(filter);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_Filter_updateCoefficients);
+
+
+// The cutoff doesn't change between LFO updates, so this is the common case
+static void BM_Filter_updateCoefficientsUnchanged(benchmark::State& state)
+{
+    auto filter = setupFilter();
+    for (auto _ : state) {
+        filter.updateCoefficients(1000.0f, 0.707f);
+        benchmark::DoNotOptimize(filter);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_Filter_updateCoefficientsUnchanged);
+
+static void BM_Filter_coefficientCache(benchmark::State& state)
+{
+    FilterCoefficientCache cache;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(1000.0f, 0.707f, 48000.0f));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_Filter_coefficientCache);
+
+// A group of voices filtered together, as VoiceBank does
+static void BM_FilterLanes_process(benchmark::State& state)
+{
+    constexpr int width = 8;
+    FilterLanes<width> lanes;
+    for (int lane = 0; lane < width; ++lane) {
+        lanes.setCoefficients(lane, jx11_Filter::calculateCoefficients(500.0f * float(lane + 1), 0.707f, 48000.0f));
+    }
+    bool active[width];
+    std::fill(std::begin(active), std::end(active), true);
+    alignas(32) float input[width];
+    alignas(32) float output[width];
+    int sample = 0;
+    for (auto _ : state) {
+        std::fill(std::begin(input), std::end(input), (++sample & 16) ? 0.5f : -0.5f);
+        lanes.process(input, active, output);
+        benchmark::DoNotOptimize(output);
+    }
+    setSampleCounters(state, width);
+}
+BENCHMARK(BM_FilterLanes_process);
+
+static void BM_FilterLanes_processAllOutputs(benchmark::State& state)
+{
+    constexpr int width = 8;
+    FilterLanes<width> lanes;
+    for (int lane = 0; lane < width; ++lane) {
+        lanes.setCoefficients(lane, jx11_Filter::calculateCoefficients(500.0f * float(lane + 1), 0.707f, 48000.0f));
+    }
+    bool active[width];
+    std::fill(std::begin(active), std::end(active), true);
+    alignas(32) float input[width];
+    FilterLanes<width>::Outputs outputs;
+    int sample = 0;
+    for (auto _ : state) {
+        std::fill(std::begin(input), std::end(input), (++sample & 16) ? 0.5f : -0.5f);
+        lanes.process(input, active, outputs);
+        benchmark::DoNotOptimize(outputs);
+    }
+    setSampleCounters(state, width);
+}
+BENCHMARK(BM_FilterLanes_processAllOutputs);
+
+// Decimates one channel of a block, counted in output samples.
+// Arguments: oversampling factor, output block size.
+static void BM_Decimator_process(benchmark::State& state)
+{
+    const int factor = int(state.range(0));
+    const int blockSize = int(state.range(1));
+    Decimator decimator;
+    decimator.prepare(factor, blockSize);
+    std::vector<float> source(static_cast<size_t>(factor * blockSize));
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = (i & 16) ? 0.5f : -0.5f;
+    }
+    std::vector<float> input(source.size());
+    std::vector<float> output(static_cast<size_t>(blockSize));
+    for (auto _ : state) {
+        // at 4x the input is used as scratch space, so start from a fresh copy each time
+        std::copy(source.begin(), source.end(), input.begin());
+        decimator.process(input.data(), output.data(), blockSize);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, blockSize);
+}
+BENCHMARK(BM_Decimator_process)->ArgNames({ "factor", "block" })->Args({ 2, 64 })->Args({ 2, 512 })->Args({ 4, 512 });
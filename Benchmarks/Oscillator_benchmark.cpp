@@ -0,0 +1,127 @@
+#pragma once
+#include "BenchmarkHelpers.h"
+#include "jx11_Oscillator.h"
+#include "PolyBLEPOscillator.h"
+#include "WavetableOscillator.h"
+#include <vector>
+
+namespace
+{
+    jx11_Oscillator setupOscillator()
+    {
+        jx11_Oscillator oscillator;
+        oscillator.reset();
+        oscillator.amplitude = 0.5f;
+        oscillator.period = notePeriod(60.0f, 48000.0f);
+        return oscillator;
+    }
+}
+
+static void BM_Oscillator_nextSample(benchmark::State& state)
+{
+    auto oscillator = setupOscillator();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(oscillator.nextSample());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_Oscillator_nextSample);
+
+static void BM_Oscillator_render(benchmark::State& state)
+{
+    auto oscillator = setupOscillator();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(oscillator.render());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_Oscillator_render);
+
+static void BM_Oscillator_renderBlock(benchmark::State& state)
+{
+    auto oscillator = setupOscillator();
+    std::vector<float> output(size_t(state.range(0)));
+    for (auto _ : state) {
+        oscillator.renderBlock(output.data(), int(output.size()));
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, state.range(0));
+}
+BENCHMARK(BM_Oscillator_renderBlock)->Arg(32)->Arg(512);
+
+static void BM_Oscillator_getNextSquareSample(benchmark::State& state)
+{
+    auto oscillator = setupOscillator();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(oscillator.getNextSquareSample());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_Oscillator_getNextSquareSample);
+
+// The sinc evaluators, over the phases of a low note
+template <float (*Sinc)(float)>
+static void BM_sinc(benchmark::State& state)
+{
+    std::vector<float> phases(512), output(512);
+    for (size_t i = 0; i < phases.size(); ++i) {
+        phases[i] = 0.5f + float(i) * 2.37f;
+    }
+    for (auto _ : state) {
+        for (size_t i = 0; i < phases.size(); ++i) {
+            output[i] = Sinc(phases[i]);
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, int64_t(phases.size()));
+}
+BENCHMARK(BM_sinc<sincExact>)->Name("BM_sincExact");
+BENCHMARK(BM_sinc<sincTable>)->Name("BM_sincTable");
+BENCHMARK(BM_sinc<sincPolynomial>)->Name("BM_sincPolynomial");
+
+// Argument: the waveform, 0 = saw, 1 = square, 2 = triangle
+static void BM_PolyBLEPOscillator_nextSample(benchmark::State& state)
+{
+    PolyBLEPOscillator oscillator;
+    oscillator.waveform = PolyBLEPOscillator::Waveform(state.range(0));
+    oscillator.amplitude = 0.5f;
+    oscillator.period = notePeriod(60.0f, 48000.0f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(oscillator.nextSample());
+    }
+    setSampleCounters(state, 1);
+}
+BENCHMARK(BM_PolyBLEPOscillator_nextSample)->DenseRange(0, 2);
+
+static void BM_PolyBLEPOscillator_renderBlock(benchmark::State& state)
+{
+    PolyBLEPOscillator oscillator;
+    oscillator.waveform = PolyBLEPOscillator::Waveform(state.range(0));
+    oscillator.amplitude = 0.5f;
+    oscillator.period = notePeriod(60.0f, 48000.0f);
+    std::vector<float> output(512);
+    for (auto _ : state) {
+        oscillator.renderBlock(output.data(), int(output.size()));
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, int64_t(output.size()));
+}
+BENCHMARK(BM_PolyBLEPOscillator_renderBlock)->DenseRange(0, 2);
+
+static void BM_WavetableOscillator_renderBlock(benchmark::State& state)
+{
+    WavetableOscillator oscillator;
+    oscillator.amplitude = 0.5f;
+    oscillator.period = notePeriod(60.0f, 48000.0f);
+    std::vector<float> output(512);
+    for (auto _ : state) {
+        oscillator.renderBlock(output.data(), int(output.size()));
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, int64_t(output.size()));
+}
+BENCHMARK(BM_WavetableOscillator_renderBlock);
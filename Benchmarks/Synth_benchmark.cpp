@@ -0,0 +1,205 @@
+#pragma once
+#include "BenchmarkHelpers.h"
+#include "Synth.h"
+#include "MultiTimbralSynth.h"
+#include "ParameterSnapshot.h"
+#include "RenderTelemetry.h"
+#include "SynthParameters.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Renders the synth with a number of held notes.
+// Arguments: voices sounding, block size, render threads, oversampling.
+static void BM_Synth_render(benchmark::State& state)
+{
+    const int numNotes = int(state.range(0));
+    const int blockSize = int(state.range(1));
+
+    Synth synth;
+    synth.setRenderThreads(int(state.range(2)));
+    synth.setOversampling(int(state.range(3)));
+    synth.allocateResources(48000.0, blockSize);
+    synth.reset();
+
+    // the default patch sustains at full level, so every note keeps sounding
+    SynthParameters parameters;
+    parameters.noise = 20.0f;
+    parameters.oscMix = 50.0f;
+    parameters.applyTo(synth, 48000.0f);
+    for (int i = 0; i < numNotes; ++i) {
+        synth.midiMessages(0x90, uint8_t(24 + (i * 7) % 96), 100);
+    }
+
+    std::vector<float> left(static_cast<size_t>(blockSize)), right(static_cast<size_t>(blockSize));
+    float* outputBuffers[2] = { left.data(), right.data() };
+    for (auto _ : state) {
+        synth.render(outputBuffers, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, blockSize);
+    state.counters["voices"] = numNotes;
+    synth.deallocateResources();
+}
+
+static void synthRenderArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({ "voices", "block", "threads", "oversampling" });
+    for (const int blockSize : { 32, 128, 512, 2048 }) {
+        benchmark->Args({ 1, blockSize, 0, 1 });
+        if (Synth::MAX_VOICES >= 8) { benchmark->Args({ 8, blockSize, 0, 1 }); }
+        if (Synth::MAX_VOICES > 8) {
+            benchmark->Args({ Synth::MAX_VOICES, blockSize, 0, 1 });
+            benchmark->Args({ Synth::MAX_VOICES, blockSize, 3, 1 });
+        }
+    }
+    for (const int oversampling : { 2, 4 }) {
+        benchmark->Args({ std::min(Synth::MAX_VOICES, 8), 512, 0, oversampling });
+    }
+}
+BENCHMARK(BM_Synth_render)->Apply(synthRenderArguments)->UseRealTime();
+
+// Renders a number of parts, each with a chord held, mixed to two stereo buses.
+// Arguments: parts playing, render threads.
+static void BM_MultiTimbral_render(benchmark::State& state)
+{
+    constexpr int blockSize = 512;
+    const int numParts = int(state.range(0));
+
+    MultiTimbralSynth multiSynth;
+    SynthParameters parameters;
+    parameters.oscMix = 50.0f;
+    for (int channel = 0; channel < numParts; ++channel) {
+        parameters.filterFreq = 40.0f + 4.0f * float(channel);
+        multiSynth.setPartEnabled(channel, true);
+        multiSynth.setPartBus(channel, channel % 2);
+        multiSynth.setPartParameters(channel, parameters);
+    }
+    multiSynth.setRenderThreads(int(state.range(1)));
+    multiSynth.setOversampling(1);
+    multiSynth.allocateResources(48000.0, blockSize);
+    multiSynth.reset();
+    for (int channel = 0; channel < numParts; ++channel) {
+        for (int i = 0; i < std::min(Synth::MAX_VOICES, 4); ++i) {
+            multiSynth.midiMessages(uint8_t(0x90 | channel), uint8_t(36 + channel * 3 + i * 7), 100);
+        }
+    }
+
+    std::vector<float> outputs(static_cast<size_t>(4 * blockSize));
+    float* channels[4] = { outputs.data(), outputs.data() + blockSize, outputs.data() + 2 * blockSize,
+                           outputs.data() + 3 * blockSize };
+    for (auto _ : state) {
+        multiSynth.render(channels, 4, blockSize);
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, blockSize);
+    state.counters["voices"] = multiSynth.getActiveVoiceCount();
+    multiSynth.deallocateResources();
+}
+BENCHMARK(BM_MultiTimbral_render)
+    ->ArgNames({ "parts", "threads" })
+    ->Args({ 1, 0 })
+    ->Args({ 4, 0 })
+    ->Args({ 4, 3 })
+    ->Args({ 16, 0 })
+    ->Args({ 16, 3 })
+    ->Args({ 16, 7 })
+    ->UseRealTime();
+
+// The per block parameter update, with one parameter automated (range 0) or all of them recalculated (range 1)
+static void BM_SynthParameters_update(benchmark::State& state)
+{
+    const bool everything = state.range(0) != 0;
+    Synth synth;
+    std::array<std::atomic<float>, SynthParameters::COUNT> values;
+    ParameterSnapshot snapshot;
+    const SynthParameters defaults;
+    for (int index = 0; index < SynthParameters::COUNT; ++index) {
+        values[size_t(index)].store(defaults.*SynthParameters::entries[size_t(index)].value);
+        snapshot.setSource(index, &values[size_t(index)]);
+    }
+    snapshot.update();
+
+    float automation = 0.0f;
+    for (auto _ : state) {
+        automation = (automation >= 1.0f) ? 0.0f : automation + 0.01f;
+        values[20].store(automation); // lfoRate
+        if (everything) { snapshot.invalidate(); }
+        snapshot.current().applyTo(synth, 48000.0f, snapshot.update());
+        benchmark::DoNotOptimize(synth.lfoInc);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_SynthParameters_update)->ArgName("all")->Arg(0)->Arg(1);
+
+// Dense MIDI with every voice sounding: a glissando of note ons and offs, with the sustain
+// pedal going down and up every 16 notes, so notes are looked up, held and voices stolen.
+// Counted in MIDI events.
+static void BM_Synth_midiMessages(benchmark::State& state)
+{
+    Synth synth;
+    synth.allocateResources(48000.0, 512);
+    synth.reset();
+    SynthParameters parameters;
+    parameters.applyTo(synth, 48000.0f);
+    for (int i = 0; i < Synth::MAX_VOICES; ++i) {
+        synth.midiMessages(0x90, uint8_t(i % 128), 100);
+    }
+
+    int note = 0;
+    for (auto _ : state) {
+        note = (note + 7) % 128;
+        if (note % 16 == 0) { synth.midiMessages(0xB0, 0x40, 127); }
+        if (note % 16 == 8) { synth.midiMessages(0xB0, 0x40, 0); }
+        synth.midiMessages(0x90, uint8_t(note), 100);
+        synth.midiMessages(0x80, uint8_t((note + 64) % 128), 0);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+    synth.deallocateResources();
+}
+BENCHMARK(BM_Synth_midiMessages);
+
+// Automating the envelope, a parameter change per block, and a stream of pitch bend messages
+static void BM_Synth_envelopeAndPitchBend(benchmark::State& state)
+{
+    Synth synth;
+    synth.allocateResources(48000.0, 512);
+    synth.reset();
+    SynthParameters parameters;
+    parameters.applyTo(synth, 48000.0f);
+    const auto envelope = SynthParameters::maskOf(&SynthParameters::envAttack) | SynthParameters::maskOf(&SynthParameters::envDecay)
+                        | SynthParameters::maskOf(&SynthParameters::envRelease);
+
+    int step = 0;
+    for (auto _ : state) {
+        step = (step + 1) % 101;
+        parameters.envAttack = float(step);
+        parameters.envDecay = float(100 - step);
+        parameters.envRelease = float(step);
+        parameters.applyTo(synth, 48000.0f, envelope);
+        synth.midiMessages(0xE0, uint8_t(step), uint8_t(step + 13));
+        benchmark::DoNotOptimize(synth.envAttack);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+    synth.deallocateResources();
+}
+BENCHMARK(BM_Synth_envelopeAndPitchBend);
+
+// What the telemetry costs the audio thread each block, reading the clock twice and pushing a record
+static void BM_RenderTelemetry_endBlock(benchmark::State& state)
+{
+    RenderTelemetry telemetry;
+    telemetry.prepare(48000.0);
+    const OutputSafety::Counters safety;
+    int blocks = 0;
+    for (auto _ : state) {
+        telemetry.endBlock(RenderTelemetry::startBlock(), 512, 8, 0, safety);
+        if (++blocks % 256 == 0) {
+            state.PauseTiming();
+            telemetry.poll();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_RenderTelemetry_endBlock);
@@ -0,0 +1,376 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file Main.cpp
+* @author CS Islay
+* @brief JX11Render: renders a MIDI file through the synth to a WAV file,
+*        without a plugin host and as fast as the CPU allows.
+*
+* Usage: JX11Render input.mid output.wav [options]
+*
+*   --params <file>     parameter values, one "id value" per line (# comments)
+*   --set <id>=<value>  set one parameter, after any parameter file
+*   --part <ch>=<file>  play MIDI channel ch (1 to 16) with its own parameter file.
+*                       With any parts, only their channels are heard, and --params
+*                       and --set are not used
+*   --sample-rate <hz>  default 48000
+*   --block-size <n>    samples rendered per call to Synth::render, default 4096
+*   --threads <n>       worker threads for rendering the voices, or the parts, default 0
+*   --control-interval <n>  samples between modulation updates, default 32
+*   --oversampling <n>  render the voices at 1, 2 or 4 times the sample rate
+*   --noise <colour>    white (the default) or pink
+*   --voice-noise       give each voice its own noise rather than sharing one stream
+*   --tail <seconds>    time rendered after the last MIDI event, default 2
+*   --bits <n>          16, 24 or 32 (float), default 24
+*   --stats             print a histogram of the render time of each block
+*
+* Parameter IDs and units are those of the plugin, see SynthParameters.h.
+*****************************************************************************/
+
+#include <JuceHeader.h>
+#include "MultiTimbralSynth.h"
+#include "OutputSafety.h"
+#include "RenderTelemetry.h"
+#include "Synth.h"
+#include "SynthParameters.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <optional>
+
+namespace
+{
+    struct Options
+    {
+        juce::File midiFile;
+        juce::File outputFile;
+        SynthParameters parameters;
+        std::array<std::optional<SynthParameters>, MultiTimbralSynth::NUM_PARTS> parts; ///< By MIDI channel
+        double sampleRate = 48000.0;
+        int blockSize = 4096;
+        int threads = 0;
+        int controlInterval = Synth::DEFAULT_CONTROL_INTERVAL;
+        int oversampling = Synth::DEFAULT_OVERSAMPLING;
+        NoiseColour noiseColour = NoiseColour::White;
+        bool noisePerVoice = false;
+        double tailSeconds = 2.0;
+        int bitsPerSample = 24;
+        bool printStats = false;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: JX11Render input.mid output.wav [--params file] [--set id=value]...\n"
+                     "                  [--part channel=file]...\n"
+                     "                  [--sample-rate hz] [--block-size n] [--threads n]\n"
+                     "                  [--control-interval n] [--oversampling 1|2|4]\n"
+                     "                  [--noise white|pink] [--voice-noise]\n"
+                     "                  [--tail seconds] [--bits 16|24|32] [--stats]\n";
+    }
+
+    bool setParameter(SynthParameters& parameters, const juce::String& id, const juce::String& value)
+    {
+        if (!parameters.set(id.trim().toStdString(), value.trim().getFloatValue())) {
+            std::cerr << "Unknown parameter: " << id.trim() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool loadParameters(SynthParameters& parameters, const juce::File& file)
+    {
+        if (!file.existsAsFile()) {
+            std::cerr << "Can't find parameter file " << file.getFullPathName() << "\n";
+            return false;
+        }
+
+        juce::StringArray lines;
+        file.readLines(lines);
+        for (auto line : lines) {
+            line = line.upToFirstOccurrenceOf("#", false, false).trim();
+            if (line.isEmpty()) { continue; }
+
+            // "id value" or "id = value"
+            const auto id = line.initialSectionNotContaining(" \t=");
+            const auto value = line.substring(id.length()).trimCharactersAtStart(" \t=");
+            if (!setParameter(parameters, id, value)) { return false; }
+        }
+        return true;
+    }
+
+    bool parseArguments(const int argc, char* argv[], Options& options)
+    {
+        juce::StringArray positional;
+        for (int i = 1; i < argc; ++i) {
+            const juce::String argument(argv[i]);
+            if (!argument.startsWith("--")) {
+                positional.add(argument);
+                continue;
+            }
+            if (argument == "--stats") {
+                options.printStats = true;
+                continue;
+            }
+            if (argument == "--voice-noise") {
+                options.noisePerVoice = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << argument << "\n";
+                return false;
+            }
+            const juce::String value(argv[++i]);
+
+            if (argument == "--params") {
+                if (!loadParameters(options.parameters, juce::File::getCurrentWorkingDirectory().getChildFile(value))) {
+                    return false;
+                }
+            } else if (argument == "--set") {
+                if (!value.containsChar('=')
+                    || !setParameter(options.parameters, value.upToFirstOccurrenceOf("=", false, false),
+                                     value.fromFirstOccurrenceOf("=", false, false))) {
+                    return false;
+                }
+            } else if (argument == "--part") {
+                const int channel = value.upToFirstOccurrenceOf("=", false, false).trim().getIntValue();
+                if (!value.containsChar('=') || channel < 1 || channel > MultiTimbralSynth::NUM_PARTS) {
+                    std::cerr << "Invalid part " << value << "\n";
+                    return false;
+                }
+                auto& part = options.parts[size_t(channel - 1)];
+                part.emplace();
+                const auto file = value.fromFirstOccurrenceOf("=", false, false).trim();
+                if (!loadParameters(*part, juce::File::getCurrentWorkingDirectory().getChildFile(file))) {
+                    return false;
+                }
+            } else if (argument == "--sample-rate") {
+                options.sampleRate = value.getDoubleValue();
+            } else if (argument == "--block-size") {
+                options.blockSize = value.getIntValue();
+            } else if (argument == "--threads") {
+                options.threads = value.getIntValue();
+            } else if (argument == "--control-interval") {
+                options.controlInterval = value.getIntValue();
+            } else if (argument == "--oversampling") {
+                options.oversampling = value.getIntValue();
+            } else if (argument == "--noise") {
+                if (value != "white" && value != "pink") {
+                    std::cerr << "Unknown noise colour " << value << "\n";
+                    return false;
+                }
+                options.noiseColour = (value == "pink") ? NoiseColour::Pink : NoiseColour::White;
+            } else if (argument == "--tail") {
+                options.tailSeconds = value.getDoubleValue();
+            } else if (argument == "--bits") {
+                options.bitsPerSample = value.getIntValue();
+            } else {
+                std::cerr << "Unknown option " << argument << "\n";
+                return false;
+            }
+        }
+
+        if (positional.size() != 2) { return false; }
+        options.midiFile = juce::File::getCurrentWorkingDirectory().getChildFile(positional[0]);
+        options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(positional[1]);
+
+        if (options.sampleRate <= 0.0 || options.blockSize <= 0 || options.threads < 0 || options.controlInterval <= 0
+            || (options.oversampling != 1 && options.oversampling != 2 && options.oversampling != 4)
+            || options.tailSeconds < 0.0
+            || (options.bitsPerSample != 16 && options.bitsPerSample != 24 && options.bitsPerSample != 32)) {
+            std::cerr << "Invalid option value\n";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads every track of a MIDI file into one sequence, timed in seconds.
+     */
+    bool loadMidi(const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midiFile;
+        if (!stream.openedOk() || !midiFile.readFrom(stream)) {
+            std::cerr << "Can't read MIDI file " << file.getFullPathName() << "\n";
+            return false;
+        }
+
+        midiFile.convertTimestampTicksToSeconds();
+        for (int track = 0; track < midiFile.getNumTracks(); ++track) {
+            sequence.addSequence(*midiFile.getTrack(track), 0.0);
+        }
+        sequence.sort();
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    juce::MidiMessageSequence sequence;
+    if (!loadMidi(options.midiFile, sequence)) { return 1; }
+
+    options.outputFile.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(options.outputFile);
+    if (stream->failedToOpen()) {
+        std::cerr << "Can't write " << options.outputFile.getFullPathName() << "\n";
+        return 1;
+    }
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        wavFormat.createWriterFor(stream.get(), options.sampleRate, 2, options.bitsPerSample, {}, 0));
+    if (writer == nullptr) {
+        std::cerr << "Can't create a WAV writer for " << options.outputFile.getFullPathName() << "\n";
+        return 1;
+    }
+    stream.release(); // the writer owns the stream now
+
+    // One synth for every channel, or with --part a synth for each channel given
+    const bool multiTimbral = std::any_of(options.parts.begin(), options.parts.end(),
+                                          [](const auto& part) { return part.has_value(); });
+    Synth synth;
+    MultiTimbralSynth multiSynth;
+    auto setUp = [&options](Synth& part) {
+        part.setControlInterval(options.controlInterval);
+        part.setNoiseColour(options.noiseColour);
+        part.setNoisePerVoice(options.noisePerVoice);
+    };
+    if (multiTimbral) {
+        for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+            const auto& part = options.parts[size_t(channel)];
+            multiSynth.setPartEnabled(channel, part.has_value());
+            if (part.has_value()) {
+                setUp(multiSynth.getPart(channel));
+                multiSynth.setPartParameters(channel, *part);
+            }
+        }
+        multiSynth.setRenderThreads(options.threads);
+        multiSynth.setOversampling(options.oversampling);
+        multiSynth.allocateResources(options.sampleRate, options.blockSize);
+        multiSynth.reset();
+    } else {
+        setUp(synth);
+        synth.setRenderThreads(options.threads);
+        synth.setOversampling(options.oversampling);
+        synth.allocateResources(options.sampleRate, options.blockSize);
+        synth.reset();
+        options.parameters.applyTo(synth, float(options.sampleRate));
+    }
+    auto render = [&](float** outputBuffers, const int sampleCount) {
+        if (multiTimbral) {
+            multiSynth.render(outputBuffers, 2, sampleCount);
+        } else {
+            synth.render(outputBuffers, sampleCount);
+        }
+    };
+
+    const double lastEventTime = (sequence.getNumEvents() > 0) ? sequence.getEndTime() : 0.0;
+    const auto totalSamples = juce::int64(std::ceil((lastEventTime + options.tailSeconds) * options.sampleRate));
+
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    OutputSafety outputSafety;
+    RenderTelemetry telemetry;
+    telemetry.prepare(options.sampleRate);
+    juce::ScopedNoDenormals noDenormals;
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Render a block at a time, splitting each block at its MIDI events so they land on the right sample
+    int eventIndex = 0;
+    for (juce::int64 blockStart = 0; blockStart < totalSamples; blockStart += options.blockSize) {
+        const int blockSize = int(std::min(juce::int64(options.blockSize), totalSamples - blockStart));
+        const auto blockStartTime = RenderTelemetry::startBlock();
+        float* outputBuffers[2] = { buffer.getWritePointer(0), buffer.getWritePointer(1) };
+
+        int bufferOffset = 0;
+        while (eventIndex < sequence.getNumEvents()) {
+            const auto& message = sequence.getEventPointer(eventIndex)->message;
+            const auto eventSample = juce::int64(std::llround(message.getTimeStamp() * options.sampleRate));
+            if (eventSample >= blockStart + blockSize) { break; }
+
+            const int samplesThisSegment = int(std::max(eventSample - blockStart, juce::int64(0))) - bufferOffset;
+            if (samplesThisSegment > 0) {
+                float* segmentBuffers[2] = { outputBuffers[0] + bufferOffset, outputBuffers[1] + bufferOffset };
+                render(segmentBuffers, samplesThisSegment);
+                bufferOffset += samplesThisSegment;
+            }
+
+            if (!message.isMetaEvent() && !message.isSysEx() && message.getRawDataSize() <= 3) {
+                const auto* data = message.getRawData();
+                const int numBytes = message.getRawDataSize();
+                const uint8_t data1 = (numBytes >= 2) ? data[1] : 0;
+                const uint8_t data2 = (numBytes == 3) ? data[2] : 0;
+                if (multiTimbral) {
+                    multiSynth.midiMessages(data[0], data1, data2);
+                } else {
+                    synth.midiMessages(data[0], data1, data2);
+                }
+            }
+            ++eventIndex;
+        }
+
+        if (blockSize > bufferOffset) {
+            float* segmentBuffers[2] = { outputBuffers[0] + bufferOffset, outputBuffers[1] + bufferOffset };
+            render(segmentBuffers, blockSize - bufferOffset);
+        }
+        outputSafety.process(outputBuffers, 2, blockSize);
+        const int activeVoices = multiTimbral ? multiSynth.getActiveVoiceCount() : synth.getActiveVoiceCount();
+        const auto voicesStolen = multiTimbral ? multiSynth.getVoicesStolen() : synth.getVoicesStolen();
+        telemetry.endBlock(blockStartTime, blockSize, activeVoices, voicesStolen, outputSafety.counters());
+        telemetry.poll();
+
+        if (!writer->writeFromAudioSampleBuffer(buffer, 0, blockSize)) {
+            std::cerr << "Failed writing " << options.outputFile.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+    writer.reset();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    const double audioSeconds = double(totalSamples) / options.sampleRate;
+    std::cout << "Rendered " << audioSeconds << " s of audio in " << elapsed.count() << " s ("
+              << audioSeconds / std::max(elapsed.count(), 1e-9) << "x real time)\n";
+
+    const auto& stats = telemetry.summary();
+    std::cout << "Block load " << stats.averageLoad() * 100.0 << "% average, " << stats.peakLoad * 100.0f << "% peak; "
+              << stats.maxActiveVoices << " voices at most, " << stats.voicesStolen << " stolen\n";
+    if (options.printStats) {
+        std::cout << "Block render time, as a share of the block's duration:\n";
+        for (int bucket = 0; bucket < RenderTelemetry::HISTOGRAM_BUCKETS; ++bucket) {
+            const juce::String range = (bucket + 1 < RenderTelemetry::HISTOGRAM_BUCKETS)
+                ? juce::String(bucket * 10) + "-" + juce::String(bucket * 10 + 10) + "%"
+                : juce::String(">= 100%");
+            std::cout << "  " << range.paddedRight(' ', 8) << stats.loadHistogram[size_t(bucket)] << "\n";
+        }
+    }
+
+    const auto safety = outputSafety.counters();
+    if (safety.mutedBlocks > 0 || safety.clampedSamples > 0) {
+        std::cout << "Output safety: " << safety.mutedBlocks << " blocks muted (" << safety.nonFiniteBlocks
+                  << " not finite), " << safety.clampedSamples << " samples clamped\n";
+    }
+
+    synth.deallocateResources();
+    multiSynth.deallocateResources();
+    return 0;
+}
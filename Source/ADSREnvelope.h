@@ -24,7 +24,10 @@ Y8,    "88,,8P  88        88  88  88           88              `8b
 ************************************************************************/
 
 #pragma once
+#include "ParameterTables.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 const float SILENCE = 0.0001f;
 
 class ADSREnvelope
@@ -49,6 +52,45 @@ public:
         return level;   
     }
 
+    /**
+     * @brief Renders a block of envelope values, stopping early if the envelope goes silent.
+     *
+     * Each stage is a one pole approach to its target, so its level after n samples is
+     * target + (level - target) * multiplier^n. Whole runs are worked out from that directly,
+     * without a dependency from one sample to the next, and the block is only split at the
+     * sample where the attack peaks or the envelope goes silent. nextValue() rounds its level
+     * to a float every sample and the closed form doesn't, so the two drift apart over a long
+     * stage, by up to about 1e-4 of the level, and a stage can end a sample earlier or later.
+     *
+     * @param output The buffer to write the values to.
+     * @param sampleCount The maximum number of values to render.
+     * @return The number of values rendered before the envelope went silent.
+     */
+    int renderBlock(float* output, const int sampleCount)
+    {
+        int i = 0;
+        while (i < sampleCount && isActive())
+        {
+            const int stageLength = samplesUntilStageEnds();
+            const int runLength = std::min(sampleCount - i, stageLength);
+            renderRun(output + i, runLength);
+            i += runLength;
+
+            if (runLength == stageLength)
+            {
+                if (isInAttack()) {
+                    multiplier = decayMultiplier;
+                    target = sustainLevel;
+                } else {
+                    // make sure the rounding agrees that it's silent
+                    level = std::min(level, SILENCE);
+                    output[i - 1] = level;
+                }
+            }
+        }
+        return i;
+    }
+
     void reset()
     {
         level = 0.0f;
@@ -89,12 +131,12 @@ public:
 
     void setAttack(float normalisedAttack)
     {
-        attackMultiplier = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * normalisedAttack));
+        attackMultiplier = std::exp(-inverseSampleRate * envelopeRate(normalisedAttack));
     }
 
     void setDecay(float normalisedDecay)
     {
-        decayMultiplier = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * normalisedDecay));
+        decayMultiplier = std::exp(-inverseSampleRate * envelopeRate(normalisedDecay));
     }
 
     void setSustain(float normalisedSustain)
@@ -107,7 +149,7 @@ public:
         if (normalisedRelease < 1.0f) {
             releaseMultiplier = 0.75f; // extra fast release
         } else {
-            releaseMultiplier = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * normalisedRelease));
+            releaseMultiplier = std::exp(-inverseSampleRate * envelopeRate(normalisedRelease));
         }
 
 
@@ -129,6 +171,73 @@ public:
     float releaseMultiplier = 0.0f;
 
 private:
+    template <int NumVoices> friend class VoiceBank;
+
+    static constexpr int NEVER = std::numeric_limits<int>::max();
+    static constexpr int RUN_LANES = 8; ///< Samples computed together by renderRun
+
+    /**
+     * @brief Works out how many samples nextValue() would take to reach the end of the stage:
+     * the peak of the attack, or silence for a stage heading below SILENCE.
+     * @return The number of samples, including the one that reaches the end, or NEVER.
+     */
+    int samplesUntilStageEnds() const
+    {
+        const bool fadingOut = !isInAttack() && target < SILENCE;
+        if (!isInAttack() && !fadingOut) { return NEVER; } // settles on its sustain level
+        if (multiplier <= 0.0f) { return 1; } // jumps straight to the target
+        if (multiplier >= 1.0f) { return NEVER; } // holds its level
+
+        const double logMultiplier = std::log(double(multiplier));
+        const double difference = double(level) - double(target);
+        double samples;
+        if (isInAttack()) {
+            // the first n where level + target > 3
+            const double ratio = (3.0 - 2.0 * double(target)) / difference;
+            if (ratio >= 1.0) { return 1; }
+            samples = std::floor(std::log(ratio) / logMultiplier) + 1.0;
+        } else {
+            // the first n where level <= SILENCE
+            const double ratio = (double(SILENCE) - double(target)) / difference;
+            if (ratio >= 1.0) { return 1; }
+            samples = std::ceil(std::log(ratio) / logMultiplier);
+        }
+        return int(std::clamp(samples, 1.0, double(NEVER)));
+    }
+
+    /**
+     * @brief Renders count samples of the current stage from the closed form, RUN_LANES at a time.
+     */
+    void renderRun(float* output, const int count)
+    {
+        alignas(32) float powers[RUN_LANES]; // multiplier^1 to multiplier^RUN_LANES
+        double power = 1.0;
+        for (int j = 0; j < RUN_LANES; ++j)
+        {
+            power *= double(multiplier);
+            powers[j] = float(power);
+        }
+
+        double difference = double(level) - double(target);
+        int i = 0;
+        for (; i + RUN_LANES <= count; i += RUN_LANES)
+        {
+            const float runDifference = float(difference);
+            for (int j = 0; j < RUN_LANES; ++j)
+            {
+                output[i + j] = target + runDifference * powers[j];
+            }
+            difference *= power;
+        }
+        const float runDifference = float(difference);
+        for (int j = 0; i + j < count; ++j)
+        {
+            output[i + j] = target + runDifference * powers[j];
+        }
+
+        level = output[count - 1];
+    }
+
     float multiplier = 0.0f; /**<The multiplier used to calculate the next value. */
     float target = 0.0f; /**<The target value of the envelope. */
     float inverseSampleRate = 1.0f / sampleRate;
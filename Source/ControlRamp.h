@@ -0,0 +1,135 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file ControlRamp.h
+* @author CS Islay
+* @brief A value that moves in a straight line to a new target over a number
+*        of samples.
+*
+* Modulation and parameter changes are worked out at control rate, every few
+* samples, and the audio loops follow them with a ramp instead of jumping, so
+* there are no zipper steps. The value at sample i of a ramp is computed
+* directly as value + step * i, so the loops have no dependency between
+* samples and vectorise.
+*****************************************************************************/
+
+#pragma once
+#include <algorithm>
+
+class ControlRamp
+{
+public:
+    /**
+     * @brief Forgets the current value, so the next target is jumped to rather than ramped to.
+     */
+    void reset()
+    {
+        primed = false;
+        step = 0.0f;
+        remaining = 0;
+    }
+
+    /**
+     * @brief Jumps straight to a value.
+     */
+    void setValue(const float value)
+    {
+        current = value;
+        target = value;
+        step = 0.0f;
+        remaining = 0;
+        primed = true;
+    }
+
+    /**
+     * @brief Starts a ramp from the current value to a new one.
+     * @param newTarget The value to ramp to.
+     * @param samples The length of the ramp. With 0, or after reset(), the value jumps.
+     */
+    void setTarget(const float newTarget, const int samples)
+    {
+        if (!primed || samples <= 0) {
+            setValue(newTarget);
+            return;
+        }
+        target = newTarget;
+        step = (target - current) / float(samples);
+        remaining = samples;
+    }
+
+    float getValue() const { return current; }
+    float getTarget() const { return target; }
+    bool isRamping() const { return remaining > 0; }
+
+    /**
+     * @brief Multiplies a buffer by the next count values of the ramp, without moving along it.
+     *
+     * Call advance() once every buffer that should follow the same ramp has been processed.
+     */
+    void applyGain(float* buffer, const int count) const
+    {
+        const int rampLength = std::min(count, remaining);
+        for (int i = 0; i < rampLength; ++i)
+        {
+            buffer[i] *= current + step * float(i + 1);
+        }
+        const float gain = (rampLength < count) ? target : current;
+        for (int i = rampLength; i < count; ++i)
+        {
+            buffer[i] *= gain;
+        }
+    }
+
+    /**
+     * @brief Multiplies count interleaved frames of channels samples each by the next count values
+     *        of the ramp, without moving along it.
+     */
+    void applyGain(float* frames, const int count, const int channels) const
+    {
+        const int rampLength = std::min(count, remaining);
+        for (int i = 0; i < count; ++i)
+        {
+            const float gain = (i < rampLength) ? current + step * float(i + 1) : target;
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                frames[i * channels + channel] *= gain;
+            }
+        }
+    }
+
+    /**
+     * @brief Moves the ramp on by count samples.
+     */
+    void advance(const int count)
+    {
+        if (count >= remaining) {
+            current = target;
+            step = 0.0f;
+            remaining = 0;
+        } else {
+            current += step * float(count);
+            remaining -= count;
+        }
+    }
+
+private:
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;
+    int remaining = 0;
+    bool primed = false;
+};
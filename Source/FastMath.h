@@ -0,0 +1,297 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file FastMath.h
+* @author CS Islay
+* @brief Approximations of sin, cos, exp, exp2, tan and tanh for the DSP code.
+*
+* Every function comes in two precisions, picked with a template argument:
+*
+*   Function     Low                            High
+*   sin, cos     1.1e-4 absolute                3.5e-7 absolute
+*   exp, exp2    7.5e-5 relative                1.5e-7 relative
+*   tan          3e-4 relative, |x| < 0.49 pi   3e-6 relative, |x| < 0.49 pi
+*   tanh         1e-4 absolute                  1.5e-7 absolute
+*
+* High is within a few float roundings of libm (tan loses a little more near
+* its pole, where rounding x is magnified). Low is for modulation and
+* anything else where a tenth of a percent goes unheard. The bounds are
+* checked against libm in FastMath_test.cpp.
+*
+* There are no branches or table lookups, only multiplies, adds, compares
+* and bit operations, so a loop calling them vectorises. Each function also
+* has a block version, which takes an input and an output buffer and is
+* written so that GCC vectorises it at -O2. They split the buffer with
+* forEachRun(), which the other block loops in the synth use too.
+*
+* sin and cos reduce their argument with a three-part 2 pi. That keeps full
+* accuracy for |x| up to 2^12 * 2 pi, about 25000. exp and exp2 saturate at
+* 2^-126 and 2^127 rather than producing denormals or infinities.
+*****************************************************************************/
+
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace FastMath
+{
+    enum class Precision
+    {
+        Low,
+        High
+    };
+
+    // 2 pi in three parts. k times each of the first two is exact for k < 2^12
+    inline constexpr float TWO_PI_A = 6.28125f;
+    inline constexpr float TWO_PI_B = 0.0019354820251464844f;
+    inline constexpr float TWO_PI_C = -1.7484555314695172e-07f;
+    inline constexpr float INVERSE_TWO_PI = 0.15915493667125702f;
+    inline constexpr float PI_HI = 3.1415927410125732f;
+    inline constexpr float PI_LO = -8.742277657347586e-08f; // pi - PI_HI
+    inline constexpr float HALF_PI_HI = 1.5707963705062866f;
+    inline constexpr float HALF_PI_LO = -4.371138828673793e-08f;
+    inline constexpr float LN2_HI = 0.693359375f; // exact in a few bits, so k * LN2_HI is too
+    inline constexpr float LN2_LO = -0.00021219444170128554f;
+    inline constexpr float LOG2_E = 1.4426950216293335f;
+
+    /**
+     * @brief a where condition holds, otherwise b.
+     *
+     * Done with bit masks rather than ?: so that GCC if-converts it: it won't turn a
+     * float ?: or std::min into a blend while floating-point traps are honoured.
+     */
+    inline float select(const bool condition, const float a, const float b)
+    {
+        const uint32_t mask = 0u - uint32_t(condition);
+        return std::bit_cast<float>((std::bit_cast<uint32_t>(a) & mask) | (std::bit_cast<uint32_t>(b) & ~mask));
+    }
+
+    /**
+     * @brief x limited to [low, high]. A NaN passes through.
+     */
+    inline float clamp(const float x, const float low, const float high)
+    {
+        const float atLeastLow = select(x < low, low, x);
+        return select(atLeastLow > high, high, atLeastLow);
+    }
+
+    /**
+     * @brief The nearest whole number to x, for |x| < 2^31.
+     */
+    inline float nearest(const float x)
+    {
+        return float(int(x + std::copysign(0.5f, x)));
+    }
+
+    /**
+     * @brief sin(r) for |r| <= pi/2, from a minimax polynomial.
+     */
+    template <Precision P>
+    inline float sinPolynomial(const float r)
+    {
+        const float s = r * r;
+        if constexpr (P == Precision::Low) {
+            return r * (9.998918162e-01f + s * (-1.659600981e-01f + s * 7.602894709e-03f));
+        } else {
+            return r * (1.0f + s * (-1.666665668e-01f + s * (8.333025133e-03f
+                     + s * (-1.980741829e-04f + s * 2.601902104e-06f))));
+        }
+    }
+
+    /**
+     * @brief 2^f for |f| <= ln(2) / 2 in the natural log sense, i.e. exp(f), from a minimax polynomial.
+     */
+    template <Precision P>
+    inline float expPolynomial(const float f)
+    {
+        if constexpr (P == Precision::Low) {
+            return 9.999280731e-01f + f * (1.000164236e+00f + f * (5.049633085e-01f + f * 1.656679027e-01f));
+        } else {
+            return 1.0f + f * (1.000000036e+00f + f * (4.999999208e-01f + f * (1.666642017e-01f
+                 + f * (4.166822587e-02f + f * (8.374816059e-03f + f * 1.383683048e-03f)))));
+        }
+    }
+
+    /**
+     * @brief 2^k for whole k from -126 to 127.
+     */
+    inline float powerOfTwo(const float k)
+    {
+        return std::bit_cast<float>((int32_t(k) + 127) << 23);
+    }
+
+    /**
+     * @brief x reduced to [-pi, pi], give or take a rounding.
+     */
+    inline float reduce(const float x)
+    {
+        const float k = nearest(x * INVERSE_TWO_PI);
+        return ((x - k * TWO_PI_A) - k * TWO_PI_B) - k * TWO_PI_C;
+    }
+
+    template <Precision P = Precision::High>
+    inline float sin(const float x)
+    {
+        // sin(r) = sin(pi - r) brings r to within pi/2 of zero
+        const float r = reduce(x);
+        const float reflected = (std::copysign(PI_HI, r) - r) + std::copysign(PI_LO, r);
+        return sinPolynomial<P>(select(std::abs(r) > HALF_PI_HI, reflected, r));
+    }
+
+    template <Precision P = Precision::High>
+    inline float cos(const float x)
+    {
+        // cos(r) = sin(pi/2 - |r|)
+        const float r = reduce(x);
+        return sinPolynomial<P>((HALF_PI_HI - std::abs(r)) + HALF_PI_LO);
+    }
+
+    template <Precision P = Precision::High>
+    inline float exp2(const float x)
+    {
+        // 2^x = 2^k * exp(f ln 2), and x - k is exact
+        const float clamped = clamp(x, -126.0f, 127.0f);
+        const float k = nearest(clamped);
+        return expPolynomial<P>((clamped - k) * 0.69314718056f) * powerOfTwo(k);
+    }
+
+    template <Precision P = Precision::High>
+    inline float exp(const float x)
+    {
+        // exp(x) = 2^k * exp(x - k ln 2), with k ln 2 taken off in two parts to keep the remainder exact
+        const float clamped = clamp(x, -87.3f, 88.0f);
+        const float k = nearest(clamped * LOG2_E);
+        const float f = (clamped - k * LN2_HI) - k * LN2_LO;
+        return expPolynomial<P>(f) * powerOfTwo(k);
+    }
+
+    /**
+     * @brief tan(x) for |x| < 0.49 pi, from a Pade approximant: [7/6] for High and [5/4] for Low.
+     */
+    template <Precision P = Precision::High>
+    inline float tan(const float x)
+    {
+        const float x2 = x * x;
+        if constexpr (P == Precision::Low) {
+            return x * (945.0f + x2 * (-105.0f + x2)) / (945.0f + x2 * (-420.0f + 15.0f * x2));
+        } else {
+            const float numerator = x * (135135.0f + x2 * (-17325.0f + x2 * (378.0f - x2)));
+            const float denominator = 135135.0f + x2 * (-62370.0f + x2 * (3150.0f - 28.0f * x2));
+            return numerator / denominator;
+        }
+    }
+
+    template <Precision P = Precision::High>
+    inline float tanh(const float x)
+    {
+        if constexpr (P == Precision::Low) {
+            // the [7/6] Pade approximant, which reaches 1 at |x| = 4.97, clamped there. x is
+            // limited first so that x^7 can't overflow
+            const float limited = clamp(x, -5.0f, 5.0f);
+            const float x2 = limited * limited;
+            const float numerator = limited * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+            const float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + 28.0f * x2));
+            return clamp(numerator / denominator, -1.0f, 1.0f);
+        } else {
+            // tanh|x| = (1 - e^-2|x|) / (1 + e^-2|x|), where the exponential can't overflow
+            const float e = FastMath::exp<P>(-2.0f * std::abs(x));
+            return std::copysign((1.0f - e) / (1.0f + e), x);
+        }
+    }
+
+    inline constexpr int RUN_LENGTH = 8;
+
+    /**
+     * @brief Splits count samples into runs for a loop body that should vectorise.
+     *
+     * Calls run(start, length) for each whole run of RUN_LENGTH samples, then for each
+     * sample left over with a length of 1. The length is a std::integral_constant, so
+     * every loop over it has a fixed trip count, which the compiler vectorises even when
+     * it won't risk it for a loop of unknown length.
+     */
+    template <typename Run>
+    inline void forEachRun(const int count, Run&& run)
+    {
+        const int runEnd = count - count % RUN_LENGTH;
+        for (int start = 0; start < runEnd; start += RUN_LENGTH)
+        {
+            run(start, std::integral_constant<int, RUN_LENGTH> {});
+        }
+        for (int i = runEnd; i < count; ++i)
+        {
+            run(i, std::integral_constant<int, 1> {});
+        }
+    }
+
+    /**
+     * @brief Applies a function to every sample of a buffer. The output can be the input.
+     */
+    template <typename Function>
+    inline void transform(const float* input, float* output, const int count, Function&& function)
+    {
+        forEachRun(count, [&] (const int start, const auto length) {
+            // through a local array, so the compiler needn't check whether the output overlaps the input
+            float run[decltype(length)::value];
+            for (int i = 0; i < length; ++i)
+            {
+                run[i] = function(input[start + i]);
+            }
+            for (int i = 0; i < length; ++i)
+            {
+                output[start + i] = run[i];
+            }
+        });
+    }
+
+    template <Precision P = Precision::High>
+    inline void sin(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::sin<P>(x); });
+    }
+
+    template <Precision P = Precision::High>
+    inline void cos(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::cos<P>(x); });
+    }
+
+    template <Precision P = Precision::High>
+    inline void exp2(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::exp2<P>(x); });
+    }
+
+    template <Precision P = Precision::High>
+    inline void exp(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::exp<P>(x); });
+    }
+
+    template <Precision P = Precision::High>
+    inline void tan(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::tan<P>(x); });
+    }
+
+    template <Precision P = Precision::High>
+    inline void tanh(const float* input, float* output, const int count)
+    {
+        transform(input, output, count, [] (const float x) { return FastMath::tanh<P>(x); });
+    }
+}
@@ -0,0 +1,254 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file HalfBandDecimator.h
+* @author CS Islay
+* @brief Halves the sample rate of a signal with a linear phase half-band
+*        FIR lowpass, for bringing oversampled audio back to the host rate.
+*
+* A half-band filter's response is symmetric about a quarter of the input
+* rate, so every other tap is zero apart from the centre one, which is 0.5.
+* Split into polyphase form, the odd input samples only meet the centre tap
+* and the even ones meet the NumPairs symmetric pairs of the rest:
+*
+*     y[n] = 0.5 * odd[n - NumPairs] + sum_j g[j] * (even[n - NumPairs - j] + even[n - NumPairs + j + 1])
+*
+* so each output costs NumPairs multiplies, a quarter of the direct form.
+* The block is split into its even and odd samples first, after the history
+* from the last block, and then the outputs are worked out 8 at a time, each
+* tap applied to all 8 in turn, so the loops are contiguous and vectorise.
+*
+* The taps are a Kaiser windowed sinc. With 16 pairs (63 taps) the stopband
+* is below -79 dB, and nothing above 0.58 of the output rate can alias below
+* 0.42 of it, i.e. 20 kHz at 48 kHz. A first stage at four times the output
+* rate only has to keep its aliases out of that band, so 6 pairs give the
+* same -80 dB there.
+*****************************************************************************/
+
+#pragma once
+#include "FastMath.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+template <int NumPairs>
+class HalfBandDecimator
+{
+public:
+    static_assert(NumPairs > 0, "a half-band filter needs at least one pair of taps");
+
+    /**
+     * @brief The delay of the filter, in samples at the input rate.
+     */
+    static constexpr int LATENCY = 2 * NumPairs - 1;
+
+    HalfBandDecimator() : pairs(designPairs()) {}
+
+    /**
+     * @brief Allocates the buffers.
+     * @param maxOutputSamples The most samples process() will be asked for at once.
+     */
+    void prepare(const int maxOutputSamples)
+    {
+        evens.assign(size_t(EVEN_HISTORY + maxOutputSamples), 0.0f);
+        odds.assign(size_t(ODD_HISTORY + maxOutputSamples), 0.0f);
+    }
+
+    /**
+     * @brief Clears the history.
+     */
+    void reset()
+    {
+        std::fill(evens.begin(), evens.end(), 0.0f);
+        std::fill(odds.begin(), odds.end(), 0.0f);
+    }
+
+    /**
+     * @brief Filters and decimates a block.
+     *
+     * The output may be the same buffer as the input, so stages can be chained in place.
+     *
+     * @param input 2 * outputCount samples at the input rate.
+     * @param output outputCount samples at half the rate.
+     * @param outputCount The number of output samples, no more than was prepared for.
+     */
+    void process(const float* input, float* output, const int outputCount)
+    {
+        float* even = evens.data() + EVEN_HISTORY;
+        float* odd = odds.data() + ODD_HISTORY;
+        for (int i = 0; i < outputCount; ++i)
+        {
+            even[i] = input[2 * i];
+            odd[i] = input[2 * i + 1];
+        }
+
+        FastMath::forEachRun(outputCount, [this, output] (const int start, const auto length) {
+            filterRun<decltype(length)::value>(start, output);
+        });
+
+        // keep the end of the block for the next one
+        std::copy(evens.begin() + outputCount, evens.begin() + outputCount + EVEN_HISTORY, evens.begin());
+        std::copy(odds.begin() + outputCount, odds.begin() + outputCount + ODD_HISTORY, odds.begin());
+    }
+
+    /**
+     * @brief The taps either side of the centre, nearest first.
+     */
+    const std::array<float, NumPairs>& getPairs() const { return pairs; }
+
+private:
+    static constexpr int EVEN_HISTORY = 2 * NumPairs - 1;
+    static constexpr int ODD_HISTORY = NumPairs;
+    static constexpr double KAISER_BETA = 8.0;
+
+    std::array<float, NumPairs> pairs;
+    std::vector<float> evens; ///< EVEN_HISTORY samples from earlier blocks, then this block's even samples
+    std::vector<float> odds; ///< ODD_HISTORY samples from earlier blocks, then this block's odd samples
+
+    /**
+     * @brief Works out Count outputs from the split samples, starting at output start.
+     */
+    template <int Count>
+    void filterRun(const int start, float* output) const
+    {
+        float sum[Count];
+        const float* odd = odds.data() + start;
+        for (int i = 0; i < Count; ++i)
+        {
+            sum[i] = 0.5f * odd[i];
+        }
+        for (int j = 0; j < NumPairs; ++j)
+        {
+            const float gain = pairs[size_t(j)];
+            const float* before = evens.data() + start + (NumPairs - 1 - j);
+            const float* after = evens.data() + start + (NumPairs + j);
+            for (int i = 0; i < Count; ++i)
+            {
+                sum[i] += gain * (before[i] + after[i]);
+            }
+        }
+        for (int i = 0; i < Count; ++i)
+        {
+            output[start + i] = sum[i];
+        }
+    }
+
+    /**
+     * @brief The modified Bessel function I0, from its power series.
+     */
+    static double besselI0(const double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50 && term > 1e-12 * sum; ++k)
+        {
+            const double factor = x / (2.0 * k);
+            term *= factor * factor;
+            sum += term;
+        }
+        return sum;
+    }
+
+    static std::array<float, NumPairs> designPairs()
+    {
+        constexpr double pi = 3.14159265358979323846;
+        const double halfLength = double(2 * NumPairs); // the window reaches zero one tap past the ends
+
+        std::array<double, NumPairs> taps {};
+        double sum = 0.0;
+        for (int j = 0; j < NumPairs; ++j)
+        {
+            const double offset = double(2 * j + 1);
+            const double sinc = std::sin(0.5 * pi * offset) / (pi * offset);
+            const double ratio = offset / halfLength;
+            const double window = besselI0(KAISER_BETA * std::sqrt(1.0 - ratio * ratio)) / besselI0(KAISER_BETA);
+            taps[size_t(j)] = sinc * window;
+            sum += 2.0 * taps[size_t(j)];
+        }
+
+        // scale the pairs so they add up to the other half of a DC gain of exactly 1
+        std::array<float, NumPairs> result {};
+        for (int j = 0; j < NumPairs; ++j)
+        {
+            result[size_t(j)] = float(taps[size_t(j)] * 0.5 / sum);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Brings one channel down from 1, 2 or 4 times the output rate, with one
+ * or two half-band stages.
+ */
+class Decimator
+{
+public:
+    static constexpr int FINAL_PAIRS = 16; ///< The stage down to the output rate
+    static constexpr int FIRST_PAIRS = 6; ///< The stage from 4x to 2x
+
+    /**
+     * @brief Allocates the buffers.
+     * @param oversampling The ratio of the input rate to the output rate: 1, 2 or 4.
+     * @param maxOutputSamples The most samples process() will be asked for at once.
+     */
+    void prepare(const int oversampling, const int maxOutputSamples)
+    {
+        factor = oversampling;
+        finalStage.prepare((factor > 1) ? maxOutputSamples : 0);
+        firstStage.prepare((factor > 2) ? 2 * maxOutputSamples : 0);
+    }
+
+    void reset()
+    {
+        finalStage.reset();
+        firstStage.reset();
+    }
+
+    /**
+     * @brief Decimates a block.
+     * @param input factor * outputCount samples. Used as scratch space at 4x.
+     * @param output outputCount samples at the output rate.
+     * @param outputCount The number of output samples.
+     */
+    void process(float* input, float* output, const int outputCount)
+    {
+        if (factor == 4) {
+            firstStage.process(input, input, 2 * outputCount);
+            finalStage.process(input, output, outputCount);
+        } else if (factor == 2) {
+            finalStage.process(input, output, outputCount);
+        } else {
+            std::copy(input, input + outputCount, output);
+        }
+    }
+
+    /**
+     * @brief The delay of the decimation, in samples at the output rate.
+     */
+    float getLatency() const
+    {
+        if (factor == 4) { return float(HalfBandDecimator<FIRST_PAIRS>::LATENCY) / 4.0f + float(HalfBandDecimator<FINAL_PAIRS>::LATENCY) / 2.0f; }
+        if (factor == 2) { return float(HalfBandDecimator<FINAL_PAIRS>::LATENCY) / 2.0f; }
+        return 0.0f;
+    }
+
+private:
+    int factor = 1;
+    HalfBandDecimator<FINAL_PAIRS> finalStage;
+    HalfBandDecimator<FIRST_PAIRS> firstStage;
+};
@@ -0,0 +1,230 @@
+#include "MultiTimbralSynth.h"
+#include <algorithm>
+
+MultiTimbralSynth::MultiTimbralSynth()
+{
+    parts[0].nextEnabled = true;
+}
+
+void MultiTimbralSynth::setPartEnabled(const int channel, const bool enabled)
+{
+    parts[size_t(channel)].nextEnabled = enabled;
+}
+
+void MultiTimbralSynth::setPartBus(const int channel, const int bus)
+{
+    parts[size_t(channel)].bus = std::max(bus, 0);
+}
+
+void MultiTimbralSynth::setPartParameters(const int channel, const SynthParameters& parameters)
+{
+    Part& part = parts[size_t(channel)];
+    const auto changed = parameters.differences(part.parameters);
+    part.parameters = parameters;
+    if (part.enabled && changed != 0)
+    {
+        part.parameters.applyTo(part.synth, hostSampleRate, changed);
+    }
+}
+
+void MultiTimbralSynth::setRenderThreads(const int numThreads)
+{
+    renderThreads = std::max(numThreads, 0);
+}
+
+void MultiTimbralSynth::setOversampling(const int factor)
+{
+    for (auto& part : parts)
+    {
+        part.synth.setOversampling(factor);
+    }
+}
+
+void MultiTimbralSynth::allocateResources(const double sampleRate, const int samplesPerBlock)
+{
+    hostSampleRate = float(sampleRate);
+    maxBlockSize = samplesPerBlock;
+    for (int channel = 0; channel < NUM_PARTS; ++channel)
+    {
+        Part& part = parts[size_t(channel)];
+        part.enabled = part.nextEnabled;
+        if (part.enabled)
+        {
+            allocatePart(part);
+        }
+        else
+        {
+            part.synth.deallocateResources();
+        }
+    }
+    updateEnabledParts();
+}
+
+void MultiTimbralSynth::switchPart(const int channel, const bool enabled)
+{
+    Part& part = parts[size_t(channel)];
+    part.nextEnabled = enabled;
+    if (maxBlockSize <= 0 || part.enabled == enabled) { return; }
+
+    part.enabled = enabled;
+    if (enabled)
+    {
+        allocatePart(part);
+        part.synth.reset();
+    }
+    else
+    {
+        part.synth.deallocateResources();
+    }
+    updateEnabledParts();
+}
+
+void MultiTimbralSynth::allocatePart(Part& part)
+{
+    // each part is rendered by one task, so it doesn't need threads of its own
+    part.synth.setRenderThreads(0);
+    part.synth.allocateResources(double(hostSampleRate), maxBlockSize);
+    part.parameters.applyTo(part.synth, hostSampleRate);
+}
+
+void MultiTimbralSynth::updateEnabledParts()
+{
+    numEnabledParts = 0;
+    for (int channel = 0; channel < NUM_PARTS; ++channel)
+    {
+        if (parts[size_t(channel)].enabled)
+        {
+            enabledParts[size_t(numEnabledParts++)] = channel;
+        }
+    }
+
+    // a stereo buffer for each part, rounded up to whole cache lines
+    partBufferStride = (maxBlockSize + 15) & ~15;
+    partBuffers.resize(size_t(numEnabledParts * 2 * partBufferStride));
+
+    const int numWorkers = (renderThreads > 0) ? std::min(renderThreads, numEnabledParts - 1) : 0;
+    if (numWorkers <= 0)
+    {
+        renderPool.stop();
+    }
+    else if (numWorkers != renderPool.getNumWorkers())
+    {
+        renderPool.start(numWorkers);
+    }
+}
+
+void MultiTimbralSynth::deallocateResources()
+{
+    renderPool.stop();
+    partBuffers = {};
+    for (auto& part : parts)
+    {
+        part.synth.deallocateResources();
+    }
+}
+
+void MultiTimbralSynth::reset()
+{
+    for (int i = 0; i < numEnabledParts; ++i)
+    {
+        parts[size_t(enabledParts[size_t(i)])].synth.reset();
+    }
+}
+
+void MultiTimbralSynth::midiMessages(const uint8_t data0, const uint8_t data1, const uint8_t data2)
+{
+    // system messages have no channel
+    if (data0 >= 0xF0) { return; }
+
+    Part& part = parts[size_t(data0 & 0x0F)];
+    if (part.enabled)
+    {
+        part.synth.midiMessages(data0, data1, data2);
+    }
+}
+
+void MultiTimbralSynth::render(float* const* outputChannels, const int numOutputChannels, const int sampleCount)
+{
+    // nothing to render into, or nothing allocated to render with
+    if (numOutputChannels <= 0 || maxBlockSize <= 0) { return; }
+
+    // the part buffers hold maxBlockSize samples, so render longer blocks in pieces
+    for (int offset = 0; offset < sampleCount; offset += maxBlockSize)
+    {
+        renderSegment(outputChannels, numOutputChannels, offset, std::min(maxBlockSize, sampleCount - offset));
+    }
+}
+
+void MultiTimbralSynth::renderSegment(float* const* outputChannels, const int numOutputChannels, const int offset,
+                                      const int sampleCount)
+{
+    segmentSize = sampleCount;
+    renderPool.run(renderPartTask, this, numEnabledParts);
+
+    for (int channel = 0; channel < numOutputChannels; ++channel)
+    {
+        std::fill(outputChannels[channel] + offset, outputChannels[channel] + offset + sampleCount, 0.0f);
+    }
+
+    // add the parts up in channel order, so the mix is the same however they were rendered
+    const int numBuses = std::max(numOutputChannels / 2, 1);
+    for (int i = 0; i < numEnabledParts; ++i)
+    {
+        const float* partLeft = partBuffers.data() + size_t(2 * i * partBufferStride);
+        const float* partRight = partLeft + partBufferStride;
+        if (numOutputChannels == 1)
+        {
+            float* mono = outputChannels[0] + offset;
+            for (int sample = 0; sample < sampleCount; ++sample)
+            {
+                mono[sample] += (partLeft[sample] + partRight[sample]) * 0.5f;
+            }
+            continue;
+        }
+
+        const int bus = parts[size_t(enabledParts[size_t(i)])].bus;
+        const int firstChannel = (bus < numBuses) ? 2 * bus : 0;
+        float* left = outputChannels[firstChannel] + offset;
+        float* right = outputChannels[firstChannel + 1] + offset;
+        for (int sample = 0; sample < sampleCount; ++sample)
+        {
+            left[sample] += partLeft[sample];
+            right[sample] += partRight[sample];
+        }
+    }
+}
+
+void MultiTimbralSynth::renderPartTask(void* context, const int taskIndex)
+{
+    auto& multiSynth = *static_cast<MultiTimbralSynth*>(context);
+    float* partLeft = multiSynth.partBuffers.data() + size_t(2 * taskIndex * multiSynth.partBufferStride);
+    float* outputBuffers[2] = { partLeft, partLeft + multiSynth.partBufferStride };
+    multiSynth.parts[size_t(multiSynth.enabledParts[size_t(taskIndex)])].synth.render(outputBuffers,
+                                                                                       multiSynth.segmentSize);
+}
+
+int MultiTimbralSynth::getActiveVoiceCount() const
+{
+    int count = 0;
+    for (int i = 0; i < numEnabledParts; ++i)
+    {
+        count += parts[size_t(enabledParts[size_t(i)])].synth.getActiveVoiceCount();
+    }
+    return count;
+}
+
+uint64_t MultiTimbralSynth::getVoicesStolen() const
+{
+    uint64_t count = 0;
+    for (const auto& part : parts)
+    {
+        count += part.synth.getVoicesStolen();
+    }
+    return count;
+}
+
+float MultiTimbralSynth::getLatency() const
+{
+    // the parts all have the same oversampling, so the same latency
+    return (numEnabledParts > 0) ? parts[size_t(enabledParts[0])].synth.getLatency() : 0.0f;
+}
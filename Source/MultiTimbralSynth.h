@@ -0,0 +1,170 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file MultiTimbralSynth.h
+* @author CS Islay
+* @brief Sixteen synths in one, a part for each MIDI channel, each with its
+*        own patch, rendered in parallel and mixed to stereo output buses.
+*
+* Synth treats every MIDI channel the same. Here each channel is routed to a
+* part of its own: a Synth with its own voices and its own SynthParameters,
+* which are applied a change at a time as with the plugin's parameter
+* snapshot. Only enabled parts are allocated and rendered.
+*
+* Each part renders into its own buffers, one task per part on a
+* RenderThreadPool, and the parts are then added to their buses in channel
+* order. The output is the same whatever the number of threads, and each
+* part sounds exactly as a Synth with the same patch would on its own.
+*****************************************************************************/
+
+#pragma once
+
+#include "RenderThreadPool.h"
+#include "Synth.h"
+#include "SynthParameters.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class MultiTimbralSynth
+{
+public:
+    static constexpr int NUM_PARTS = 16; ///< One per MIDI channel
+
+    MultiTimbralSynth();
+
+    /**
+     * @brief Sets whether a channel's part plays. Takes effect at the next call to allocateResources.
+     *
+     * MIDI on a channel whose part is off is ignored. Only the first part is on to begin with.
+     *
+     * @param channel The MIDI channel, 0 to 15.
+     */
+    void setPartEnabled(int channel, bool enabled);
+    bool isPartEnabled(int channel) const { return parts[size_t(channel)].enabled; }
+
+    /**
+     * @brief Turns a part on or off straight away, allocating or freeing only that part, so the
+     *        other parts' notes carry on. Before allocateResources it is the same as setPartEnabled.
+     *
+     * Not real-time safe: call it while render isn't running.
+     */
+    void switchPart(int channel, bool enabled);
+
+    /**
+     * @brief Sets which stereo output bus a part is mixed into. Takes effect straight away.
+     *
+     * Bus b is output channels 2b and 2b + 1. A part on a bus the output doesn't have is mixed
+     * into bus 0.
+     */
+    void setPartBus(int channel, int bus);
+    int getPartBus(int channel) const { return parts[size_t(channel)].bus; }
+
+    /**
+     * @brief Sets a part's patch, working out again only what changed since the last one.
+     *
+     * Call it from the audio thread, between calls to render.
+     */
+    void setPartParameters(int channel, const SynthParameters& parameters);
+    const SynthParameters& getPartParameters(int channel) const { return parts[size_t(channel)].parameters; }
+
+    /**
+     * @brief The synth behind a part, for its other settings. Set the oversampling here rather
+     *        than on the parts, so they all have the same latency.
+     */
+    Synth& getPart(int channel) { return parts[size_t(channel)].synth; }
+    const Synth& getPart(int channel) const { return parts[size_t(channel)].synth; }
+
+    /**
+     * @brief Sets how many worker threads render the parts. Takes effect at the next call to allocateResources.
+     *
+     * Each part renders its voices on whichever thread renders the part, so the parts' own render
+     * threads are turned off.
+     */
+    void setRenderThreads(int numThreads);
+
+    /**
+     * @brief Sets the oversampling of every part. Takes effect at the next call to allocateResources.
+     */
+    void setOversampling(int factor);
+
+    /**
+     * @brief Allocates the enabled parts and their buffers, and applies their patches at this rate.
+     */
+    void allocateResources(double sampleRate, int samplesPerBlock);
+    void deallocateResources();
+    void reset();
+
+    /**
+     * @brief Passes a MIDI message to the part for its channel.
+     */
+    void midiMessages(uint8_t data0, uint8_t data1, uint8_t data2);
+
+    /**
+     * @brief Renders every enabled part and mixes them into the outputs, which are overwritten.
+     *
+     * Does nothing before allocateResources, or without any output channels.
+     *
+     * @param outputChannels The output channels, in stereo pairs, one pair per bus. With a single
+     *                       channel, everything is mixed to mono.
+     * @param numOutputChannels The number of output channels.
+     * @param sampleCount The number of samples to render.
+     */
+    void render(float* const* outputChannels, int numOutputChannels, int sampleCount);
+
+    /**
+     * @brief The number of voices sounding, over all the parts.
+     */
+    int getActiveVoiceCount() const;
+
+    /**
+     * @brief How many notes have taken a sounding voice, over all the parts.
+     */
+    uint64_t getVoicesStolen() const;
+
+    /**
+     * @brief The delay added by oversampling, in samples at the host rate.
+     */
+    float getLatency() const;
+
+private:
+    struct Part
+    {
+        Synth synth;
+        SynthParameters parameters;
+        bool enabled = false;
+        bool nextEnabled = false;
+        int bus = 0;
+    };
+
+    std::array<Part, NUM_PARTS> parts;
+    float hostSampleRate = 44100.0f;
+    int maxBlockSize = 0;
+
+    int renderThreads = 0;
+    RenderThreadPool renderPool;
+    std::vector<float> partBuffers; ///< A stereo pair per enabled part
+    int partBufferStride = 0;
+    std::array<int, NUM_PARTS> enabledParts {}; ///< The channels that are enabled, in order
+    int numEnabledParts = 0;
+    int segmentSize = 0;
+
+    void allocatePart(Part& part);
+    void updateEnabledParts(); ///< Lists the enabled parts, and sizes the buffers and thread pool for them
+    static void renderPartTask(void* context, int taskIndex);
+    void renderSegment(float* const* outputChannels, int numOutputChannels, int offset, int sampleCount);
+};
@@ -0,0 +1,148 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file OutputSafety.h
+* @author CS Islay
+* @brief The last stage of the audio path, which keeps broken output away
+*        from the speakers (and ears).
+*
+* Run once over the whole block after the synth has rendered it. Samples a
+* little past full scale are clamped to [-1, 1]. If any sample in the block
+* is NaN, infinite or beyond +/-2 (screaming feedback) the whole block is
+* muted, in every channel.
+*
+* The check is one pass per channel with no branches: the clamp is a min and
+* a max, and the problems are gathered with compares into counts, so the loop
+* vectorises. What happened is recorded in counters that another thread can
+* read, rather than logged, as the audio thread mustn't touch strings.
+*****************************************************************************/
+
+#pragma once
+#include "FastMath.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+class OutputSafety
+{
+public:
+    static constexpr float CLAMP_LIMIT = 1.0f; ///< Samples are clamped to this
+    static constexpr float MUTE_LIMIT = 2.0f; ///< Blocks with samples past this are muted
+
+    /**
+     * @brief A copy of the counters, taken with counters().
+     */
+    struct Counters
+    {
+        uint64_t mutedBlocks = 0; ///< Blocks that were silenced
+        uint64_t nonFiniteBlocks = 0; ///< Of the muted blocks, those with a NaN or infinity
+        uint64_t clampedSamples = 0; ///< Samples clamped to full scale in blocks that weren't muted
+    };
+
+    /**
+     * @brief Clamps or mutes a block of audio in place.
+     * @param channels The channels of the block. A null channel is skipped.
+     * @param numChannels The number of channels.
+     * @param sampleCount The number of samples in each channel.
+     * @return Whether the block was muted.
+     */
+    bool process(float* const* channels, const int numChannels, const int sampleCount)
+    {
+        int unsafe = 0;
+        int nonFinite = 0;
+        int clamped = 0;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* buffer = channels[channel];
+            if (buffer == nullptr) { continue; }
+
+            FastMath::forEachRun(sampleCount, [&] (const int start, const auto length) {
+                for (int i = start; i < start + length; ++i)
+                {
+                    check(buffer[i], unsafe, nonFinite, clamped);
+                }
+            });
+        }
+
+        if (unsafe != 0) {
+            mute(channels, numChannels, sampleCount, nonFinite != 0);
+            return true;
+        }
+        if (clamped != 0) {
+            clampedSamples.store(clampedSamples.load(std::memory_order_relaxed) + uint64_t(clamped),
+                                 std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reads the counters. Safe to call from any thread while the audio thread is running.
+     */
+    Counters counters() const
+    {
+        Counters result;
+        result.mutedBlocks = mutedBlocks.load(std::memory_order_relaxed);
+        result.nonFiniteBlocks = nonFiniteBlocks.load(std::memory_order_relaxed);
+        result.clampedSamples = clampedSamples.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     * @brief Sets the counters back to zero. Call from the audio thread, or while it's stopped.
+     */
+    void resetCounters()
+    {
+        mutedBlocks.store(0, std::memory_order_relaxed);
+        nonFiniteBlocks.store(0, std::memory_order_relaxed);
+        clampedSamples.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // only the audio thread writes the counters, so they're bumped with a load and a
+    // store rather than a locked read-modify-write
+    std::atomic<uint64_t> mutedBlocks { 0 };
+    std::atomic<uint64_t> nonFiniteBlocks { 0 };
+    std::atomic<uint64_t> clampedSamples { 0 };
+
+    /**
+     * @brief Clamps one sample, noting whether it's out of range or not finite.
+     */
+    static void check(float& sample, int& unsafe, int& nonFinite, int& clamped)
+    {
+        const float magnitude = std::abs(sample);
+        // NaN fails every compare, so it's caught by the negated ones
+        unsafe |= int(!(magnitude <= MUTE_LIMIT));
+        nonFinite |= int(!(magnitude <= std::numeric_limits<float>::max()));
+        clamped += int(magnitude > CLAMP_LIMIT);
+        sample = std::min(std::max(sample, -CLAMP_LIMIT), CLAMP_LIMIT);
+    }
+
+    void mute(float* const* channels, const int numChannels, const int sampleCount, const bool nonFinite)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (channels[channel] != nullptr) { std::fill(channels[channel], channels[channel] + sampleCount, 0.0f); }
+        }
+
+        mutedBlocks.store(mutedBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (nonFinite) {
+            nonFiniteBlocks.store(nonFiniteBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+};
@@ -0,0 +1,100 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file ParameterSnapshot.h
+* @author CS Islay
+* @brief A copy of the plugin's parameters taken once per block, and which
+*        of them changed since the last one.
+*
+* The host writes parameter values to atomics in the parameter tree from any
+* thread. The snapshot keeps a pointer to each one, so reading them is a plain
+* atomic load with no lookup by ID, and compares them with the previous
+* snapshot to build the set of changed parameters. Only those are passed on
+* to SynthParameters::applyTo, so an automated parameter costs one derivation
+* per block rather than all of them.
+*
+* There are two buffers: the snapshot being filled and the current one, which
+* isn't touched until the next update swaps them. Nothing blocks or allocates.
+*****************************************************************************/
+
+#pragma once
+
+#include "SynthParameters.h"
+#include <array>
+#include <atomic>
+
+class ParameterSnapshot
+{
+public:
+    using ChangeMask = SynthParameters::ChangeMask;
+
+    /**
+     * @brief Sets where a parameter's value is read from.
+     * @param index The parameter's index in SynthParameters::entries.
+     * @param value The atomic the host writes the value to, which must outlive the snapshot.
+     */
+    void setSource(const int index, const std::atomic<float>* value)
+    {
+        sources[size_t(index)] = value;
+    }
+
+    /**
+     * @brief Makes the next update report every parameter as changed, e.g. after the sample rate changes.
+     */
+    void invalidate()
+    {
+        invalidated.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Reads every parameter and makes the result current if any of them changed.
+     *
+     * Parameters without a source keep their default values.
+     *
+     * @return The parameters that changed since the last update.
+     */
+    ChangeMask update()
+    {
+        SynthParameters& next = buffers[size_t(1 - currentIndex)];
+        for (size_t index = 0; index < sources.size(); ++index)
+        {
+            if (sources[index] != nullptr) {
+                next.*SynthParameters::entries[index].value = sources[index]->load(std::memory_order_relaxed);
+            }
+        }
+
+        ChangeMask changed = next.differences(current());
+        if (invalidated.exchange(false, std::memory_order_relaxed)) {
+            changed = SynthParameters::ALL_CHANGED;
+        }
+        if (changed != 0) {
+            currentIndex = 1 - currentIndex;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief The parameters as of the last update that found a change.
+     */
+    const SynthParameters& current() const { return buffers[size_t(currentIndex)]; }
+
+private:
+    std::array<const std::atomic<float>*, SynthParameters::COUNT> sources {};
+    std::array<SynthParameters, 2> buffers {};
+    int currentIndex = 0;
+    std::atomic<bool> invalidated { true };
+};
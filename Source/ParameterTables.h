@@ -0,0 +1,160 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file ParameterTables.h
+* @author CS Islay
+* @brief Tables for turning notes and envelope settings into the values the
+*        voices use, worked out at compile time.
+*
+* A note-on or an envelope change used to cost one or two calls to std::exp.
+* Now each is a table lookup:
+*
+* - NOTE_PERIOD_FACTORS: the period of each MIDI note, as a factor of
+*   Synth::tune, for each of the analog drift offsets. The drift is added in
+*   the exponent as before, so the periods come out exactly as they did.
+* - ENVELOPE_RATES: the rate of an envelope stage for each whole percentage,
+*   per second. EnvelopeMultipliers turns these into per-sample multipliers
+*   once the sample rate is known.
+*
+* Pitch bend stays on std::exp. It runs once per message, and a table small
+* enough to be worth having would be a product of two roundings, which is an
+* ulp out often enough to build up as phase.
+*
+* The tables hold exp() to within float rounding of the formulas they replace.
+* They are computed in double with tableExp(), because std::exp isn't
+* constexpr.
+*****************************************************************************/
+
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief exp(x) for constant expressions, accurate to about 1e-15 relative.
+ */
+constexpr double tableExp(const double x)
+{
+    // x = k ln(2) + r with |r| <= ln(2) / 2, so exp(x) = 2^k exp(r) and the series converges quickly
+    constexpr double LN2 = 0.693147180559945309417;
+    const int k = int(x / LN2 + (x < 0.0 ? -0.5 : 0.5));
+    const double r = x - double(k) * LN2;
+
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 24; ++n)
+    {
+        term *= r / double(n);
+        sum += term;
+    }
+
+    for (int i = 0; i < k; ++i) { sum *= 2.0; }
+    for (int i = 0; i > k; --i) { sum *= 0.5; }
+    return sum;
+}
+
+inline constexpr int NUM_NOTES = 128;
+inline constexpr float ANALOG_DRIFT = 0.002f; // added to the exponent per voice, for the analog detuning
+inline constexpr int ANALOG_DRIFT_VOICES = 8; // the drift repeats every this many voices
+inline constexpr int ENVELOPE_STEPS = 100; // the envelope parameters step in whole percentages
+inline constexpr float NOTE_PERIOD_SCALE = -0.05776226505f; // log(2^(-1/12)), a semitone
+inline constexpr float PITCH_BEND_SCALE = -0.000014102f; // log(2^(-2/12)) / 8192, two semitones either way
+
+/**
+ * @brief exp(NOTE_PERIOD_SCALE * note + ANALOG_DRIFT * drift) for every MIDI note, indexed [drift][note].
+ */
+inline constexpr std::array<std::array<float, NUM_NOTES>, ANALOG_DRIFT_VOICES> NOTE_PERIOD_FACTORS = [] {
+    std::array<std::array<float, NUM_NOTES>, ANALOG_DRIFT_VOICES> table {};
+    for (int drift = 0; drift < ANALOG_DRIFT_VOICES; ++drift)
+    {
+        for (int note = 0; note < NUM_NOTES; ++note)
+        {
+            // the exponent is rounded to float as the formula rounds it
+            const float exponent = NOTE_PERIOD_SCALE * float(note) + ANALOG_DRIFT * float(drift);
+            table[size_t(drift)][size_t(note)] = float(tableExp(double(exponent)));
+        }
+    }
+    return table;
+}();
+
+/**
+ * @brief exp(5.5 - 0.075 * percentage), the rate of an envelope stage per second, for 0 to 100%.
+ */
+inline constexpr std::array<float, ENVELOPE_STEPS + 1> ENVELOPE_RATES = [] {
+    std::array<float, ENVELOPE_STEPS + 1> table {};
+    for (int percentage = 0; percentage <= ENVELOPE_STEPS; ++percentage)
+    {
+        // the argument is rounded to float as the formula rounds it
+        table[size_t(percentage)] = float(tableExp(double(5.5f - 0.075f * float(percentage))));
+    }
+    return table;
+}();
+
+/**
+ * @brief The rate of an envelope stage per second. Whole percentages come from the table.
+ */
+inline float envelopeRate(const float percentage)
+{
+    const int index = int(percentage);
+    if (float(index) == percentage && index >= 0 && index <= ENVELOPE_STEPS) {
+        return ENVELOPE_RATES[size_t(index)];
+    }
+    return std::exp(5.5f - 0.075f * percentage);
+}
+
+/**
+ * @brief The per-sample multipliers of the envelope stages at one sample rate.
+ *
+ * prepare() does the only std::exp calls, once per whole percentage, so changing an
+ * envelope setting at a whole percentage is a lookup.
+ */
+class EnvelopeMultipliers
+{
+public:
+    void prepare(const float newInverseSampleRate)
+    {
+        inverseSampleRate = newInverseSampleRate;
+        for (int percentage = 0; percentage <= ENVELOPE_STEPS; ++percentage)
+        {
+            multipliers[size_t(percentage)] = std::exp(-inverseSampleRate * ENVELOPE_RATES[size_t(percentage)]);
+        }
+    }
+
+    /**
+     * @brief exp(-rate / sampleRate), the multiplier for a stage set to a percentage.
+     */
+    float operator()(const float percentage) const
+    {
+        const int index = int(percentage);
+        if (float(index) == percentage && index >= 0 && index <= ENVELOPE_STEPS) {
+            return multipliers[size_t(index)];
+        }
+        return std::exp(-inverseSampleRate * envelopeRate(percentage));
+    }
+
+private:
+    float inverseSampleRate = 1.0f / 44100.0f;
+    std::array<float, ENVELOPE_STEPS + 1> multipliers {};
+};
+
+/**
+ * @brief exp(PITCH_BEND_SCALE * (bend - 8192)) for a 14-bit pitch bend message, from 0.89 to 1.12.
+ */
+inline float pitchBendRatio(const uint8_t lsb, const uint8_t msb)
+{
+    return std::exp(PITCH_BEND_SCALE * float((lsb & 0x7F) + 128 * (msb & 0x7F) - 8192));
+}
@@ -16,6 +16,7 @@ JX11AudioProcessorEditor::JX11AudioProcessorEditor (JX11AudioProcessor& p)
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     setSize (400, 300);
+    startTimerHz (4);
 }
 
 JX11AudioProcessorEditor::~JX11AudioProcessorEditor()
@@ -31,6 +32,22 @@ void JX11AudioProcessorEditor::paint (juce::Graphics& g)
     g.setColour (juce::Colours::white);
     g.setFont (15.0f);
     g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+
+    g.setFont (12.0f);
+    g.drawFittedText (telemetryText, getLocalBounds().reduced (8), juce::Justification::bottomLeft, 2);
+}
+
+void JX11AudioProcessorEditor::timerCallback()
+{
+    auto& telemetry = audioProcessor.getTelemetry();
+    telemetry.poll();
+    const auto& summary = telemetry.summary();
+    telemetryText = "CPU " + juce::String (summary.averageLoad() * 100.0, 1) + "% average, "
+                  + juce::String (summary.peakLoad * 100.0f, 1) + "% peak, "
+                  + juce::String (telemetry.getOverruns()) + " overruns\n"
+                  + juce::String (summary.activeVoices) + " voices (" + juce::String (summary.maxActiveVoices) + " max), "
+                  + juce::String (summary.voicesStolen) + " stolen, " + juce::String (summary.mutedBlocks) + " muted";
+    repaint();
 }
 
 void JX11AudioProcessorEditor::resized()
@@ -13,22 +13,53 @@
 //==============================================================================
 JX11AudioProcessor::JX11AudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
+     : AudioProcessor (createBusesProperties())
 #endif
 {
-    parameterTree.state.addListener(this);
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        for (int index = 0; index < SynthParameters::COUNT; ++index) {
+            const auto id = partParameterID(channel, SynthParameters::entries[size_t(index)].id);
+            partParameters[size_t(channel)].setSource(index, parameterTree.getRawParameterValue(id));
+        }
+        partEnabled[size_t(channel)] = parameterTree.getRawParameterValue(partParameterID(channel, "partEnabled"));
+        partBus[size_t(channel)] = parameterTree.getRawParameterValue(partParameterID(channel, "partBus"));
+        parameterTree.addParameterListener(partParameterID(channel, "partEnabled"), this);
+    }
+
+    // the parts are rendered in parallel, and each part's voices on the thread rendering it
+    multiSynth.setRenderThreads(juce::jmax(juce::SystemStats::getNumCpus() - 1, 0));
 }
 
 JX11AudioProcessor::~JX11AudioProcessor()
 {
-    parameterTree.state.removeListener(this);
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        parameterTree.removeParameterListener(partParameterID(channel, "partEnabled"), this);
+    }
+    cancelPendingUpdate();
+}
+
+juce::AudioProcessor::BusesProperties JX11AudioProcessor::createBusesProperties()
+{
+    auto buses = BusesProperties()
+               #if ! JucePlugin_IsMidiEffect
+                #if ! JucePlugin_IsSynth
+                 .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                #endif
+                 .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+               #endif
+                 ;
+   #if ! JucePlugin_IsMidiEffect
+    // the rest are off until the host turns them on, and parts on a bus that is off play through the main one
+    for (int bus = 1; bus < NUM_OUTPUT_BUSES; ++bus) {
+        buses = buses.withOutput("Bus " + juce::String(bus + 1), juce::AudioChannelSet::stereo(), false);
+    }
+   #endif
+    return buses;
+}
+
+juce::String JX11AudioProcessor::partParameterID(const int channel, const char* id)
+{
+    return (channel == 0) ? juce::String(id) : "ch" + juce::String(channel + 1) + "_" + id;
 }
 
 //==============================================================================
@@ -96,19 +127,47 @@ void JX11AudioProcessor::changeProgramName (int index, const juce::String& newNa
 //==============================================================================
 void JX11AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    synth.allocateResources(sampleRate, samplesPerBlock);
-    parametersChanged.store(true);
-    synth.reset();
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        multiSynth.setPartEnabled(channel, partEnabled[size_t(channel)]->load() >= 0.5f);
+        partParameters[size_t(channel)].invalidate(); // the sample rate may have changed
+    }
+    multiSynth.allocateResources(sampleRate, samplesPerBlock);
+    setLatencySamples(juce::roundToInt(multiSynth.getLatency())); // from the oversampling, if any
+    telemetry.prepare(sampleRate);
+    multiSynth.reset();
+    prepared = true;
 }
 
 void JX11AudioProcessor::releaseResources()
 {
-    synth.deallocateResources();
+    prepared = false;
+    multiSynth.deallocateResources();
 }
 
 void JX11AudioProcessor::reset()
 {
-    synth.reset();
+    multiSynth.reset();
+}
+
+void JX11AudioProcessor::parameterChanged(const juce::String&, float)
+{
+    // this can be called on any thread, the audio thread included
+    triggerAsyncUpdate();
+}
+
+void JX11AudioProcessor::handleAsyncUpdate()
+{
+    if (!prepared) { return; } // the next prepareToPlay will pick the parts up
+
+    // allocate or free only the parts that were switched, and leave the others' notes alone;
+    // the callback lock waits for the block being rendered, rather than muting the next ones
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        const bool enabled = partEnabled[size_t(channel)]->load() >= 0.5f;
+        if (enabled != multiSynth.isPartEnabled(channel)) {
+            const juce::ScopedLock lock(getCallbackLock());
+            multiSynth.switchPart(channel, enabled);
+        }
+    }
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -132,6 +191,18 @@ bool JX11AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
         return false;
    #endif
 
+    // Bus b has to be output channels 2b and 2b + 1, so the other buses are stereo, turned on in
+    // order, and only next to a stereo main output
+    bool busOff = layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo();
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus) {
+        const auto channelSet = layouts.getChannelSet(false, bus);
+        if (channelSet.isDisabled()) {
+            busOff = true;
+        } else if (busOff || channelSet != juce::AudioChannelSet::stereo()) {
+            return false;
+        }
+    }
+
     return true;
   #endif
 }
@@ -140,19 +211,23 @@ bool JX11AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 void JX11AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessageList)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto blockStart = RenderTelemetry::startBlock();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    bool expected = true;
-    if (isNonRealtime() || parametersChanged.compare_exchange_strong(expected,false)) {
-        update(); // This function is used to update parameters
-    }
+    update(); // This function is used to update parameters
 
     // Process MIDI events - render is held in this too
     splitBufferByEvents(buffer, midiMessageList);
+
+    outputSafety.process(buffer.getArrayOfWritePointers(), juce::jmin(totalNumOutputChannels, buffer.getNumChannels()),
+                         buffer.getNumSamples());
+
+    telemetry.endBlock(blockStart, buffer.getNumSamples(), multiSynth.getActiveVoiceCount(),
+                       multiSynth.getVoicesStolen(), outputSafety.counters());
 }
 
 //==============================================================================
@@ -171,21 +246,42 @@ juce::AudioProcessorEditor* JX11AudioProcessor::createEditor()
 //==============================================================================
 void JX11AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // every part's parameters, by ID, as XML
+    if (const auto xml = parameterTree.copyState().createXml()) {
+        copyXmlToBinary(*xml, destData);
+    }
 }
 
 void JX11AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // parameters the state doesn't have keep their values; parts switched on or off are
+    // picked up by parameterChanged
+    const auto xml = getXmlFromBinary(data, sizeInBytes);
+    if (xml != nullptr && xml->hasTagName(parameterTree.state.getType())) {
+        parameterTree.replaceState(juce::ValueTree::fromXml(*xml));
+    }
 }
 
 //==============================================================================
 juce::AudioProcessorValueTreeState::ParameterLayout JX11AudioProcessor::createParameterLayout() {
 
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        layout.add(createPartParameters(channel));
+    }
+    return layout;
+}
+
+std::unique_ptr<juce::AudioProcessorParameterGroup> JX11AudioProcessor::createPartParameters(const int channel) {
+
+    auto group = std::make_unique<juce::AudioProcessorParameterGroup>("part" + juce::String(channel + 1),
+                                                                      "Channel " + juce::String(channel + 1), "|");
+    auto id = [channel](const char* base) { return partParameterID(channel, base); };
+    // the names of the other parts' parameters say which part they belong to, for hosts that list them all together
+    auto name = [channel](const juce::String& base) {
+        return (channel == 0) ? base : "Ch " + juce::String(channel + 1) + " " + base;
+    };
+
     // Lambda functions
     auto oscMixStringFromValue = [](float value, int)
     {
@@ -217,116 +313,126 @@ juce::AudioProcessorValueTreeState::ParameterLayout JX11AudioProcessor::createPa
     };
 
     // Parameters
-    layout.add(std::make_unique<juce::AudioParameterChoice>("polyMode", "Polyphony",
+    group->addChild(std::make_unique<juce::AudioParameterChoice>(id("polyMode"), name("Polyphony"),
                juce::StringArray{"Mono","Poly"},1));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("oscTune", "Osc Tune",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("oscTune"), name("Osc Tune"),
                juce::NormalisableRange<float>(-24.0f,24.0f,1.0f),-12.0f,
                juce::AudioParameterFloatAttributes().withLabel("semi")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("oscFine", "Osc Fine",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("oscFine"), name("Osc Fine"),
                juce::NormalisableRange<float>(-50.0f,50.0f,0.1f,0.3f,true),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("cent")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("oscMix", "Osc Mix",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("oscMix"), name("Osc Mix"),
                juce::NormalisableRange<float>(0.0f,100.0f),0.0f,
                juce::AudioParameterFloatAttributes()
                .withLabel("%")
                .withStringFromValueFunction(oscMixStringFromValue)));
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("glideMode", "Glide Mode",
+    group->addChild(std::make_unique<juce::AudioParameterChoice>(id("glideMode"), name("Glide Mode"),
                juce::StringArray{"Off", "Legato","Always"},0));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("glideRate", "Glide Rate",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("glideRate"), name("Glide Rate"),
                juce::NormalisableRange<float>(0.0f,100.f,1.0f),35.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("glideBend", "Glide Bend",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("glideBend"), name("Glide Bend"),
                juce::NormalisableRange<float>(-36.0f,36.0f,0.01f,0.4f,true),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("Semi")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterFreq", "Filter Freq.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterFreq"), name("Filter Freq."),
                juce::NormalisableRange<float>(0.0f,100.0f,0.1f),100.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterReso", "Filter Reso.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterReso"), name("Filter Reso."),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),15.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterEnv", "Filter Env.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterEnv"), name("Filter Env."),
                juce::NormalisableRange<float>(-100.0f,100.0f,0.1f),50.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterLFO", "Filter LFO",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterLFO"), name("Filter LFO"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterVelocity", "Filter Vel.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterVelocity"), name("Filter Vel."),
                juce::NormalisableRange<float>(-100.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes()
                .withLabel("%")
                .withStringFromValueFunction(filterVelocityStringFromValue)));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterAttack", "Filter Atk.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterAttack"), name("Filter Atk."),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterDecay", "Filter Dec.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterDecay"), name("Filter Dec."),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),30.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterSustain", "Filter Sus.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterSustain"), name("Filter Sus."),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("filterRelease", "Filter Rel.",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("filterRelease"), name("Filter Rel."),
                juce::NormalisableRange<float>(30.0f,30000.0f,0.01f,0.25f),1500.0f,
                juce::AudioParameterFloatAttributes().withLabel("ms")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("envAttack", "Env. Attack",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("envAttack"), name("Env. Attack"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("envDecay", "Env. Decay",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("envDecay"), name("Env. Decay"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),50.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("envSustain", "Env. Sustain",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("envSustain"), name("Env. Sustain"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),100.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("envRelease", "Env. Release",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("envRelease"), name("Env. Release"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),30.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("lfoRate", "LFO Rate",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("lfoRate"), name("LFO Rate"),
                juce::NormalisableRange<float>(),0.81f,
                juce::AudioParameterFloatAttributes()
                .withLabel("%")
                .withStringFromValueFunction(lfoRateStringFromValue)));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("vibrato", "Vibrato",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("vibrato"), name("Vibrato"),
                juce::NormalisableRange<float>(-100.0f,100.0f,0.1f),0.0f,
                juce::AudioParameterFloatAttributes()
                .withLabel("%")
                .withStringFromValueFunction(vibratoStringFromValue)));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("noise", "Noise",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("noise"), name("Noise"),
                juce::NormalisableRange<float>(0.0f,100.0f,1.0f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("%")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("octave", "Octave",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("octave"), name("Octave"),
                juce::NormalisableRange<float>(-2.0f,2.0f,1.0f),0.0f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("tuning", "Tuning",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("tuning"), name("Tuning"),
                juce::NormalisableRange<float>(-100.0f,100.0f,0.1f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("cent")));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("outputLevel", "Output Level",
+    group->addChild(std::make_unique<juce::AudioParameterFloat>(id("outputLevel"), name("Output Level"),
                juce::NormalisableRange<float>(-24.0f,6.0f,0.1f),0.0f,
                juce::AudioParameterFloatAttributes().withLabel("dB")));
 
-    return layout;
+    // after the parameters there were before parts, so the first part's keep their indices
+    group->addChild(std::make_unique<juce::AudioParameterBool>(id("partEnabled"), name("Part On"), channel == 0,
+                    juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    juce::StringArray busNames { "Main" };
+    for (int bus = 1; bus < NUM_OUTPUT_BUSES; ++bus) {
+        busNames.add("Bus " + juce::String(bus + 1));
+    }
+    group->addChild(std::make_unique<juce::AudioParameterChoice>(id("partBus"), name("Output Bus"), busNames, 0));
+
+    return group;
 }
 
 //==============================================================================
@@ -359,80 +465,32 @@ void JX11AudioProcessor::splitBufferByEvents(juce::AudioBuffer<float>& buffer, j
 }
 void JX11AudioProcessor::handleMidi(uint8_t data0, uint8_t data1, uint8_t data2)
 {
-    synth.midiMessages(data0, data1, data2);
+    // the engine passes each message to the part for its channel
+    multiSynth.midiMessages(data0, data1, data2);
 }
 
 void JX11AudioProcessor::render(juce::AudioBuffer<float>& buffer, int sampleCount, int bufferOffset)
 {
-    float* outputBuffers[2] = { nullptr, nullptr };
-    // Write first channel
-    // add offset to Pointer
-    outputBuffers[0] = buffer.getWritePointer(0) + bufferOffset;
-    // If stereo, write to 2nd channel
-    if (getTotalNumOutputChannels() > 1) {
-        outputBuffers[1] = buffer.getWritePointer(1) + bufferOffset;
+    // the buses that are on come first, a stereo pair each, so bus b is channels 2b and 2b + 1
+    float* outputBuffers[2 * NUM_OUTPUT_BUSES] = {};
+    const int numChannels = juce::jmin(getTotalNumOutputChannels(), buffer.getNumChannels(), 2 * NUM_OUTPUT_BUSES);
+    for (int channel = 0; channel < numChannels; ++channel) {
+        outputBuffers[channel] = buffer.getWritePointer(channel) + bufferOffset;
     }
     // TODO: remove raw pointers and replace with JuceAudioBuffer
-    synth.render(outputBuffers, sampleCount);
+    multiSynth.render(outputBuffers, numChannels, sampleCount);
 }
 
 void JX11AudioProcessor::update()
 {
-    // This method interfaces changes to the parameter tree to the synth engine
-    // updating ADSR TODO: tidy this up
-    // TODO: Set this up for all voices
-    float sampleRate = float(getSampleRate());
-
-    synth.setSampleRate(sampleRate);
-    synth.envAttack = synth.calculateAttackFromPercentage(parameterTree.getRawParameterValue("envAttack")->load());
-    synth.envDecay = synth.calculateDecayFromPercentage(parameterTree.getRawParameterValue("envDecay")->load());
-    synth.envSustain = synth.calculateSustainFromPercentage(parameterTree.getRawParameterValue("envSustain")->load());
-    synth.envRelease = synth.calculateReleaseFromPercentage(parameterTree.getRawParameterValue("envRelease")->load());
-
-
-    // Oscillators
-    synth.oscMix = parameterTree.getRawParameterValue("oscMix")->load() / 100.0f;
-    float semi = parameterTree.getRawParameterValue("oscTune")->load();
-    float cent = parameterTree.getRawParameterValue("oscFine")->load();
-    synth.detune = std::pow(1.059463094359f, -semi - 0.01f * cent);
-    // This is equivalent to std::exp2((-semi - 0.01f * cent) / 12.0f)
-
-    // Synth tuning
-    float octave = parameterTree.getRawParameterValue("octave")->load();
-    float tuning = parameterTree.getRawParameterValue("tuning")->load();
-
-    // synth.tune = octave * 12.0f + tuning / 100.0f;
-    float tuneInSemi = -36.3763f - 12.0f * octave - tuning / 100.0f;
-    synth.tune = sampleRate * std::exp(0.05776226505f * tuneInSemi);
-    
-    // Poly/Mono
-    auto polyMode = parameterTree.getRawParameterValue("polyMode")->load();
-    synth.numVoices = (polyMode == 0) ? 1 : synth.MAX_VOICES;
-
-    // Lfo parameters
-    const float inverseUpdateRate =  synth.LFO_MAX / sampleRate;
-    float lfoRate = std::exp(7.0f * parameterTree.getRawParameterValue("lfoRate")->load() - 4.0f);
-    synth.lfoInc = lfoRate * inverseUpdateRate * static_cast<float>(TWO_PI);
-
-    // get the pointer to the atomic and load it, then scale it
-    float noiseCopy = parameterTree.getRawParameterValue("noise")->load() / 100.0f;
-    // Save to Synth object
-    noiseCopy *= noiseCopy;
-    synth.noiseMix = noiseCopy * 0.06f;
-
-    synth.volumeTrim = 0.0008f * (3.2f - synth.oscMix - 25.0f * synth.noiseMix) * 1.5f;
-    // This formula comes from the JX10, and why it was chosen is unknown, but it works for automatic gain control.
-    // I may want to move this to the synth engine
-
-    synth.outputLevel = juce::Decibels::decibelsToGain(parameterTree.getRawParameterValue("outputLevel")->load());
-
-    float filterVelocity = parameterTree.getRawParameterValue("filterVelocity")->load();
-    if (filterVelocity < -90.0f) {
-        synth.velocitySensitivity = 0.0f;
-        synth.ignoreVelocity = true;
-    } else {
-        synth.velocitySensitivity = 0.0005f * filterVelocity;
-        synth.ignoreVelocity = false;
+    // This method interfaces changes to the parameter tree to the synth engine,
+    // working out again only what depends on the parameters that changed, part by part
+    for (int channel = 0; channel < MultiTimbralSynth::NUM_PARTS; ++channel) {
+        multiSynth.setPartBus(channel, int(partBus[size_t(channel)]->load()));
+        ParameterSnapshot& snapshot = partParameters[size_t(channel)];
+        if (snapshot.update() != 0) {
+            multiSynth.setPartParameters(channel, snapshot.current());
+        }
     }
 }
 //==============================================================================
@@ -8,12 +8,19 @@
 
 #pragma once
 #include <JuceHeader.h>
-#include "Synth.h"
-#include "Utils.h"
+#include "MultiTimbralSynth.h"
+#include "ParameterSnapshot.h"
+#include "RenderTelemetry.h"
+#include "SynthParameters.h"
+#include "OutputSafety.h"
+#include <array>
 //==============================================================================
-class JX11AudioProcessor  : public juce::AudioProcessor, private juce::ValueTree::Listener
+class JX11AudioProcessor  : public juce::AudioProcessor,
+                            private juce::AudioProcessorValueTreeState::Listener,
+                            private juce::AsyncUpdater
 {
 public:
+    static constexpr int NUM_OUTPUT_BUSES = 8; ///< The main stereo output and seven more for parts to go to
     //==============================================================================
     juce::AudioProcessorValueTreeState parameterTree { *this, nullptr, "Parameters", createParameterLayout() };
 
@@ -55,6 +62,24 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    /**
+     * @brief How often the output has had to be clamped or muted, for showing on the message thread.
+     */
+    OutputSafety::Counters getOutputSafetyCounters() const { return outputSafety.counters(); }
+
+    /**
+     * @brief The render time and voice counts of each block, for one reader on the message thread to poll.
+     */
+    RenderTelemetry& getTelemetry() { return telemetry; }
+
+    /**
+     * @brief The ID of one of a part's parameters. The part for MIDI channel 1 has the plain IDs, and
+     *        its synth parameters come first, in the same order, so automation from before there were
+     *        parts still finds them by ID or index. The others are prefixed, e.g. "ch2_oscMix".
+     * @param channel The MIDI channel, 0 to 15.
+     */
+    static juce::String partParameterID(int channel, const char* id);
+
 private:
     //==============================================================================
     // Synth Parameters
@@ -86,21 +111,29 @@ private:
     juce::AudioParameterChoice* polyMode;
     //==============================================================================
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    static std::unique_ptr<juce::AudioProcessorParameterGroup> createPartParameters(int channel);
+    static juce::AudioProcessor::BusesProperties createBusesProperties();
     //==============================================================================
 
     void splitBufferByEvents(juce::AudioBuffer<float>&buffer, juce::MidiBuffer& midiMessages);
     void handleMidi(uint8_t data0, uint8_t data1, uint8_t data2);
     void render(juce::AudioBuffer<float>& buffer, int sampleCount, int bufferOffset);
 
-    Synth synth;
+    MultiTimbralSynth multiSynth; // a Synth for each MIDI channel
+    OutputSafety outputSafety; // clamps or mutes the whole block once it has been rendered
+    RenderTelemetry telemetry;
     //==============================================================================
     private:
-    std::atomic<bool> parametersChanged { false }; // Use an atomic bool to check for any parameter changes
-    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override
-    {
-      parametersChanged.store(true);
-    }
+    // each part's parameters, read from the parameter tree at the start of each block
+    std::array<ParameterSnapshot, MultiTimbralSynth::NUM_PARTS> partParameters;
+    std::array<std::atomic<float>*, MultiTimbralSynth::NUM_PARTS> partEnabled {};
+    std::array<std::atomic<float>*, MultiTimbralSynth::NUM_PARTS> partBus {};
     void update();
+
+    // turning a part on or off allocates it, so that is done on the message thread
+    bool prepared = false;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JX11AudioProcessor)
 };
@@ -0,0 +1,200 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file RenderTelemetry.h
+* @author CS Islay
+* @brief Measures how long each block takes to render and what the synth was
+*        doing, for finding dropouts without a profiler.
+*
+* The audio thread times the block and pushes one BlockRecord per block into
+* an SpscRing, which is all it does: no locks, no allocation and no strings.
+* A reader on another thread (the editor's timer, a test, the command line
+* renderer) calls poll() to drain the ring into a Summary: a histogram of
+* load, the peak and average load, the most voices sounding, voices stolen
+* and output safety events.
+*
+* Load is the render time over the duration of the block, so anything at
+* 1 or above missed its deadline. Overruns are also counted on the audio
+* thread, so none are missed if the ring fills up because nobody polls.
+*****************************************************************************/
+
+#pragma once
+#include "OutputSafety.h"
+#include "SpscRing.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class RenderTelemetry
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int HISTOGRAM_BUCKETS = 11; ///< Tenths of the block's duration, and one for overruns
+    static constexpr size_t RING_SIZE = 1024; ///< Over 10 seconds of 512 sample blocks at 48 kHz
+
+    /**
+     * @brief What happened in one block.
+     */
+    struct BlockRecord
+    {
+        float renderSeconds = 0.0f;
+        float load = 0.0f; ///< renderSeconds over the duration of the block
+        int32_t sampleCount = 0;
+        int32_t activeVoices = 0; ///< Voices sounding at the end of the block
+        uint32_t voicesStolen = 0;
+        uint32_t clampedSamples = 0;
+        bool muted = false; ///< Whether the output safety stage silenced the block
+    };
+
+    /**
+     * @brief The blocks read so far by poll().
+     */
+    struct Summary
+    {
+        uint64_t blocks = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+        float peakLoad = 0.0f;
+        std::array<uint64_t, HISTOGRAM_BUCKETS> loadHistogram {};
+        int activeVoices = 0; ///< In the latest block
+        int maxActiveVoices = 0;
+        uint64_t voicesStolen = 0;
+        uint64_t mutedBlocks = 0;
+        uint64_t clampedSamples = 0;
+
+        /**
+         * @brief The total render time over the total audio time.
+         */
+        double averageLoad() const { return (audioSeconds > 0.0) ? renderSeconds / audioSeconds : 0.0; }
+    };
+
+    /**
+     * @brief Sets the sample rate the load is worked out at. Call while the audio thread is stopped.
+     */
+    void prepare(const double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+    }
+
+    /**
+     * @brief Notes the time a block starts. Call on the audio thread.
+     */
+    static Clock::time_point startBlock() { return Clock::now(); }
+
+    /**
+     * @brief Records a block that started at start. Call on the audio thread.
+     *
+     * The totals are those the synth and safety stage keep, and the record holds
+     * the change since the last block.
+     *
+     * @param start The time from startBlock().
+     * @param sampleCount The length of the block.
+     * @param activeVoices The number of voices sounding.
+     * @param voicesStolenTotal The number of voices the synth has stolen so far.
+     * @param safety The output safety counters.
+     */
+    void endBlock(const Clock::time_point start, const int sampleCount, const int activeVoices,
+                  const uint64_t voicesStolenTotal, const OutputSafety::Counters& safety)
+    {
+        const std::chrono::duration<float> elapsed = Clock::now() - start;
+        const float blockSeconds = float(sampleCount / sampleRate);
+
+        BlockRecord record;
+        record.renderSeconds = elapsed.count();
+        record.load = (blockSeconds > 0.0f) ? record.renderSeconds / blockSeconds : 0.0f;
+        record.sampleCount = sampleCount;
+        record.activeVoices = activeVoices;
+        record.voicesStolen = uint32_t(voicesStolenTotal - lastVoicesStolen);
+        record.clampedSamples = uint32_t(safety.clampedSamples - lastSafety.clampedSamples);
+        record.muted = safety.mutedBlocks != lastSafety.mutedBlocks;
+        lastVoicesStolen = voicesStolenTotal;
+        lastSafety = safety;
+
+        if (record.load >= 1.0f) { increment(overruns); }
+        if (!ring.push(record)) { increment(droppedRecords); }
+    }
+
+    /**
+     * @brief Reads the blocks recorded since the last call into the summary. Call on one reader thread.
+     * @return The number of blocks read.
+     */
+    int poll()
+    {
+        int count = 0;
+        BlockRecord record;
+        while (ring.pop(record))
+        {
+            add(record);
+            ++count;
+        }
+        return count;
+    }
+
+    const Summary& summary() const { return totals; }
+
+    /**
+     * @brief Starts the summary again, from the reader thread.
+     */
+    void resetSummary() { totals = {}; }
+
+    /**
+     * @brief Blocks that took longer than their duration, counted on the audio thread.
+     */
+    uint64_t getOverruns() const { return overruns.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Blocks that weren't summarised because the ring was full.
+     */
+    uint64_t getDroppedRecords() const { return droppedRecords.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing<BlockRecord, RING_SIZE> ring;
+    double sampleRate = 48000.0;
+
+    // audio thread only
+    uint64_t lastVoicesStolen = 0;
+    OutputSafety::Counters lastSafety;
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<uint64_t> droppedRecords { 0 };
+
+    // reader thread only
+    Summary totals;
+
+    static void increment(std::atomic<uint64_t>& counter)
+    {
+        // only the audio thread writes, so there's no need for a locked read-modify-write
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void add(const BlockRecord& record)
+    {
+        totals.blocks++;
+        totals.audioSeconds += double(record.sampleCount) / sampleRate;
+        totals.renderSeconds += double(record.renderSeconds);
+        totals.peakLoad = std::max(totals.peakLoad, record.load);
+        const int bucket = std::clamp(int(record.load * 10.0f), 0, HISTOGRAM_BUCKETS - 1);
+        totals.loadHistogram[size_t(bucket)]++;
+        totals.activeVoices = record.activeVoices;
+        totals.maxActiveVoices = std::max(totals.maxActiveVoices, record.activeVoices);
+        totals.voicesStolen += record.voicesStolen;
+        totals.mutedBlocks += record.muted ? 1 : 0;
+        totals.clampedSamples += record.clampedSamples;
+    }
+};
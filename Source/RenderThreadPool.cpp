@@ -0,0 +1,160 @@
+#include "RenderThreadPool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
+// How many times an idle worker checks for a new run before it parks
+constexpr int SPIN_COUNT = 4096;
+
+namespace
+{
+    uint64_t packRange(const uint32_t run, const int next, const int end)
+    {
+        return (uint64_t(run) << 32) | (uint64_t(next) << 16) | uint64_t(end);
+    }
+}
+
+RenderThreadPool::~RenderThreadPool()
+{
+    stop();
+}
+
+void RenderThreadPool::start(const int numWorkers)
+{
+    stop();
+
+    ranges = std::make_unique<TaskRange[]>(size_t(numWorkers + 1));
+    running.store(true);
+    workers.reserve(size_t(numWorkers));
+    for (int workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+    {
+        workers.emplace_back([this, workerIndex] { workerLoop(workerIndex); });
+    }
+}
+
+void RenderThreadPool::stop()
+{
+    if (workers.empty()) { return; }
+
+    running.store(false);
+    runCount.fetch_add(1);
+    runCount.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    ranges.reset();
+}
+
+void RenderThreadPool::run(const Task task, void* context, const int numTasks)
+{
+    if (numTasks <= 0) { return; }
+
+    if (workers.empty())
+    {
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            task(context, taskIndex);
+        }
+        return;
+    }
+
+    currentTask.store(task, std::memory_order_relaxed);
+    currentContext.store(context, std::memory_order_relaxed);
+    tasksRemaining.store(numTasks, std::memory_order_relaxed);
+
+    // split the tasks evenly between the workers and this thread
+    const uint32_t run = runCount.load(std::memory_order_relaxed) + 1;
+    const int numRanges = getNumRanges();
+    for (int rangeIndex = 0; rangeIndex < numRanges; ++rangeIndex)
+    {
+        const int begin = numTasks * rangeIndex / numRanges;
+        const int end = numTasks * (rangeIndex + 1) / numRanges;
+        ranges[size_t(rangeIndex)].state.store(packRange(run, begin, end), std::memory_order_relaxed);
+    }
+
+    // publish the run, only waking the operating system if a worker has parked
+    runCount.store(run, std::memory_order_seq_cst);
+    if (parkedWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        runCount.notify_all();
+    }
+
+    work(numRanges - 1, run);
+
+    // every task has been claimed, wait for the ones still being rendered by workers
+    while (tasksRemaining.load(std::memory_order_acquire) > 0)
+    {
+        pause();
+    }
+}
+
+void RenderThreadPool::workerLoop(const int workerIndex)
+{
+    uint32_t lastRun = runCount.load(std::memory_order_acquire);
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        uint32_t run = runCount.load(std::memory_order_acquire);
+        for (int spin = 0; spin < SPIN_COUNT && run == lastRun; ++spin)
+        {
+            pause();
+            run = runCount.load(std::memory_order_acquire);
+        }
+
+        if (run == lastRun)
+        {
+            parkedWorkers.fetch_add(1, std::memory_order_seq_cst);
+            runCount.wait(lastRun, std::memory_order_seq_cst);
+            parkedWorkers.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        lastRun = run;
+        work(workerIndex, run);
+    }
+}
+
+void RenderThreadPool::work(const int rangeIndex, const uint32_t run)
+{
+    // work through our own range first, then steal from the others
+    const int numRanges = getNumRanges();
+    for (int offset = 0; offset < numRanges; ++offset)
+    {
+        const int victim = (rangeIndex + offset) % numRanges;
+        while (runNextTask(victim, run)) {}
+    }
+}
+
+bool RenderThreadPool::runNextTask(const int rangeIndex, const uint32_t run)
+{
+    auto& state = ranges[size_t(rangeIndex)].state;
+    uint64_t range = state.load(std::memory_order_acquire);
+
+    int taskIndex = 0;
+    do
+    {
+        taskIndex = int((range >> 16) & 0xFFFF);
+        const int end = int(range & 0xFFFF);
+        if (uint32_t(range >> 32) != run || taskIndex >= end) { return false; }
+    } while (!state.compare_exchange_weak(range, range + (uint64_t(1) << 16), std::memory_order_acq_rel));
+
+    // the run can't move on until this task is finished, so the task and context are still current
+    currentTask.load(std::memory_order_relaxed)(currentContext.load(std::memory_order_relaxed), taskIndex);
+    tasksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void RenderThreadPool::pause()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
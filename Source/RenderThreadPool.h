@@ -0,0 +1,104 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file RenderThreadPool.h
+* @author CS Islay
+* @brief A pool of worker threads that help the audio thread render.
+*
+* The workers are started ahead of time and run() is safe to call from the
+* audio thread: it doesn't allocate, lock or wait on the operating system.
+* The tasks of a run are split into one range per thread (the workers plus the
+* calling thread). Each thread works through its own range and then steals
+* from the others, so a slow or descheduled worker never holds up the block;
+* the calling thread just finishes the tasks itself. Idle workers spin for a
+* short while and then park until the next run.
+*
+*****************************************************************************/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class RenderThreadPool
+{
+public:
+    /**
+     * @brief The function run for each task, given the context passed to run() and the task index.
+     */
+    using Task = void (*)(void* context, int taskIndex);
+
+    RenderThreadPool() = default;
+    ~RenderThreadPool();
+
+    RenderThreadPool(const RenderThreadPool&) = delete;
+    RenderThreadPool& operator=(const RenderThreadPool&) = delete;
+
+    /**
+     * @brief Starts the worker threads, stopping any that are already running. Not real-time safe.
+     * @param numWorkers The number of worker threads, not counting the thread that calls run().
+     */
+    void start(int numWorkers);
+
+    /**
+     * @brief Stops and joins the worker threads. Not real-time safe.
+     */
+    void stop();
+
+    int getNumWorkers() const { return int(workers.size()); }
+
+    /**
+     * @brief Runs a set of tasks on the workers and the calling thread, returning once all are done.
+     *
+     * With no workers, the tasks are run in order on the calling thread.
+     *
+     * @param task The function to run for each task.
+     * @param context Passed to every call of the task function.
+     * @param numTasks The number of tasks, up to MAX_TASKS.
+     */
+    void run(Task task, void* context, int numTasks);
+
+    static constexpr int MAX_TASKS = 0xFFFF;
+
+private:
+    // A range of task indices packed into one word, tagged with the run it belongs to:
+    // bits 32-63 hold the run, 16-31 the next task to hand out and 0-15 the end of the range.
+    // Claiming a task is a compare-and-swap that fails if the range belongs to an earlier run.
+    struct alignas(64) TaskRange
+    {
+        std::atomic<uint64_t> state { 0 };
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<TaskRange[]> ranges; // one per worker, then one for the calling thread
+
+    std::atomic<Task> currentTask { nullptr };
+    std::atomic<void*> currentContext { nullptr };
+    std::atomic<uint32_t> runCount { 0 };
+    std::atomic<int> tasksRemaining { 0 };
+    std::atomic<int> parkedWorkers { 0 };
+    std::atomic<bool> running { false };
+
+    void workerLoop(int workerIndex);
+    void work(int rangeIndex, uint32_t run);
+    bool runNextTask(int rangeIndex, uint32_t run);
+    int getNumRanges() const { return getNumWorkers() + 1; }
+
+    static void pause();
+};
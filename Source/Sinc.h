@@ -0,0 +1,152 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file Sinc.h
+* @author CS Islay
+* @brief The sinc function sin(x) / x used by the BLIT oscillators.
+*
+* There are three ways of evaluating it, chosen at build time with the
+* JX11_SINC CMake option:
+*
+* - Exact: sin in double precision and a divide, as the oscillator always has.
+* - Table: linear interpolation in a table of sin(r) / r, 1024 steps over [0, pi/2].
+* - Polynomial: a degree 8 minimax polynomial in r, evaluated as degree 4 in r^2.
+*
+* The table and polynomial reduce x to r in [-pi/2, pi/2] with x = n * pi + r,
+* so sin(x) / x = (-1)^n * (sin(r) / r) * (r / x). For |x| < pi/2 that is just
+* sin(r) / r, so there's no divide and no loss of accuracy near x = 0.
+*
+* Error bounds against sin(x) / x over |x| <= 40000 (well past the phaseMax
+* of the lowest note at 192 kHz), checked in Sinc_test.cpp:
+*
+* - Table: 2.0e-7 absolute
+* - Polynomial: 1.5e-7 absolute
+*
+* That's around 1 LSB of 24-bit audio for a full scale oscillator.
+*
+* JX11_SINC picks the evaluator for a voice rendered on its own. VoiceBank
+* always uses the polynomial, which has no branches or table lookups, so it
+* vectorises across the voices where the double precision sin doesn't.
+*****************************************************************************/
+
+#pragma once
+#include "FastMath.h"
+#include <array>
+#include <cmath>
+
+// 0 = Exact, 1 = Table, 2 = Polynomial
+#ifndef JX11_SINC
+    #define JX11_SINC 0
+#endif
+
+enum class SincMethod
+{
+    Exact = 0,
+    Table = 1,
+    Polynomial = 2
+};
+
+inline constexpr SincMethod SINC_METHOD = SincMethod(JX11_SINC);
+
+inline constexpr int SINC_TABLE_SIZE = 1024; // intervals over [0, pi/2]
+inline constexpr double SINC_PI = 3.14159265358979323846;
+
+/**
+ * @brief sin(x) / x, computed in double precision. Not defined at x = 0.
+ */
+inline float sincExact(const float x)
+{
+    return float(std::sin(double(x)) / x);
+}
+
+/**
+ * @brief Reduces x to r in [-pi/2, pi/2] and works out the factor (-1)^n * r / x
+ * that turns sin(r) / r into sin(x) / x.
+ */
+inline float reduceSincArgument(const float x, float& factor)
+{
+    // in double, as n * pi has to be exact to well below the spacing of floats near x
+    const int n = int(double(x) * (1.0 / SINC_PI) + std::copysign(0.5, double(x)));
+    const float r = float(double(x) - double(n) * SINC_PI);
+    const float sign = float(1 - 2 * (n & 1));
+    factor = FastMath::select(n == 0, 1.0f, sign * r / x);
+    return r;
+}
+
+inline const std::array<float, SINC_TABLE_SIZE + 2> SINC_TABLE = [] {
+    const auto sinc = [] (const int i) {
+        const double r = double(i) * (SINC_PI / 2.0) / SINC_TABLE_SIZE;
+        return (i == 0) ? 1.0 : std::sin(r) / r;
+    };
+
+    // A straight line between two points of sin(r) / r falls short of the curve by h^2 f'' / 12
+    // on average, and the oscillator's leaky integrator would add that up into a DC offset.
+    // Nudging each point by the same amount makes the interpolation error average out to zero.
+    std::array<float, SINC_TABLE_SIZE + 2> table {};
+    for (int i = 0; i < int(table.size()); ++i)
+    {
+        const double secondDifference = sinc(i + 1) - 2.0 * sinc(i) + sinc(std::abs(i - 1));
+        table[size_t(i)] = float(sinc(i) - secondDifference / 12.0);
+    }
+    return table;
+}();
+
+/**
+ * @brief sin(x) / x from an interpolated table.
+ */
+inline float sincTable(const float x)
+{
+    float factor;
+    const float r = reduceSincArgument(x, factor);
+
+    // the last entry is padding, for r a rounding error past pi/2
+    const float position = std::abs(r) * float(SINC_TABLE_SIZE / (SINC_PI / 2.0));
+    const int index = int(position);
+    const float fraction = position - float(index);
+    const float a = SINC_TABLE[size_t(index)];
+    const float b = SINC_TABLE[size_t(index) + 1];
+    return (a + fraction * (b - a)) * factor;
+}
+
+/**
+ * @brief sin(x) / x from a polynomial.
+ */
+inline float sincPolynomial(const float x)
+{
+    float factor;
+    const float r = reduceSincArgument(x, factor);
+
+    // minimax fit of sin(r) / r on [0, pi/2], in powers of r^2
+    const float s = r * r;
+    const float q = 1.0f + s * (-1.666665822e-01f + s * (8.333050646e-03f + s * (-1.980907546e-04f + s * 2.605224836e-06f)));
+    return q * factor;
+}
+
+/**
+ * @brief amplitude * sin(x) / x, with the sinc evaluator chosen for this build.
+ */
+inline float scaledSinc(const float amplitude, const float x)
+{
+    if constexpr (SINC_METHOD == SincMethod::Table) {
+        return amplitude * sincTable(x);
+    } else if constexpr (SINC_METHOD == SincMethod::Polynomial) {
+        return amplitude * sincPolynomial(x);
+    } else {
+        // the same double precision expression the oscillator has always used
+        return float(amplitude * std::sin(double(x)) / x);
+    }
+}
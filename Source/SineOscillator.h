@@ -29,6 +29,7 @@
 
 #pragma once
 #include "Oscillator.h"
+#include "FastMath.h"
 #include <cmath>
 
 class SineOscillator : public Oscillator
@@ -94,9 +95,9 @@ public:
          */
         void reset() override
         {
-            sin0 = amplitude * sinf(phase * TWO_PI);
-            sin1 = amplitude * sinf((phase - inc) * TWO_PI);
-            dsin = 2.0f * cosf(inc * TWO_PI);
+            sin0 = amplitude * FastMath::sin(phase * TWO_PI);
+            sin1 = amplitude * FastMath::sin((phase - inc) * TWO_PI);
+            dsin = 2.0f * FastMath::cos(inc * TWO_PI);
         }
 
         /**
@@ -115,6 +116,6 @@ public:
             auto sinx = dsin * sin0 + sin1;
             sin1 = sin0;
             sin0 = sinx;
-            return amplitude * sinf(TWO_PI * phase);
+            return amplitude * FastMath::sin(TWO_PI * phase);
         };
 };
\ No newline at end of file
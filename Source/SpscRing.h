@@ -0,0 +1,86 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file SpscRing.h
+* @author CS Islay
+* @brief A fixed size queue from one thread to another, for passing data off
+*        the audio thread without locks.
+*
+* One thread pushes and one other thread pops. Neither ever waits: a push to
+* a full ring fails and the item is dropped, and a pop from an empty ring
+* fails. The indices only ever count up, and the slot is the index modulo
+* the capacity, so full and empty can be told apart without a spare slot.
+* Each index is on its own cache line, so the two threads don't contend
+* for the line holding it.
+*****************************************************************************/
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t Capacity>
+class SpscRing
+{
+public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "the capacity must be a power of 2");
+
+    /**
+     * @brief Adds an item. Only call from the producer thread.
+     * @return false if the ring was full, in which case the item is dropped.
+     */
+    bool push(const T& item)
+    {
+        const size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == Capacity) { return false; }
+        items[write & MASK] = item;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest item. Only call from the consumer thread.
+     * @return false if the ring was empty.
+     */
+    bool pop(T& item)
+    {
+        const size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire)) { return false; }
+        item = items[read & MASK];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief The number of items waiting. Exact on the consumer thread; a snapshot elsewhere.
+     */
+    size_t size() const
+    {
+        // the read index first, as the write index can only have moved further on since
+        const size_t read = readIndex.load(std::memory_order_acquire);
+        return writeIndex.load(std::memory_order_acquire) - read;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(64) std::atomic<size_t> writeIndex { 0 };
+    alignas(64) std::atomic<size_t> readIndex { 0 };
+    alignas(64) std::array<T, Capacity> items {};
+};
@@ -1,6 +1,5 @@
 #pragma once
 #include "Synth.h"
-#include "Utils.h"
 
 
 
@@ -12,32 +11,138 @@ Synth::Synth()
     sampleRate = 44100.0f;
 }
 
-void Synth::allocateResources(double sampleRate_,int /*samplesPerBlock*/)
+void Synth::allocateResources(double sampleRate_,int samplesPerBlock)
 {
-    sampleRate = static_cast<float>(sampleRate_);
+    // the voices run at the oversampled rate, and so does everything in samples
+    oversampling = nextOversampling;
+    sampleRate = static_cast<float>(sampleRate_) * float(oversampling);
+    controlInterval = nextControlInterval * oversampling;
+
+    // white noise spreads the same power over a wider band when oversampled, so
+    // scale it up to keep the level below the host's Nyquist
+    noiseScale = std::sqrt(float(oversampling));
+
+    // blocks longer than this are rendered in several goes
+    maxBlockSize = std::max(samplesPerBlock, nextControlInterval) * oversampling;
+    noiseBuffer.resize(size_t(maxBlockSize));
+    noisePerVoice = nextNoisePerVoice;
+    if (noisePerVoice)
+    {
+        voiceNoiseStride = maxBlockSize * VoiceBank<MAX_VOICES>::LANE_WIDTH;
+        voiceNoiseBuffer.resize(size_t(VoiceBank<MAX_VOICES>::NUM_GROUPS * voiceNoiseStride));
+    }
+    else
+    {
+        voiceNoiseBuffer = {};
+    }
+    monoBuffer.resize(size_t(maxBlockSize));
+    controlChunks.resize(size_t(maxBlockSize / controlInterval + 2));
+
+    if (oversampling > 1)
+    {
+        oversampledLeft.resize(size_t(maxBlockSize));
+        oversampledRight.resize(size_t(maxBlockSize));
+    }
+    else
+    {
+        oversampledLeft = {};
+        oversampledRight = {};
+    }
+    for (auto& decimator : decimators)
+    {
+        decimator.prepare(oversampling, maxBlockSize / oversampling);
+    }
 
     for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
     {
         voices[voiceIndex].filter.setSampleRate(sampleRate);
+        voices[voiceIndex].allocateResources(maxBlockSize);
+    }
+
+    // each voice group gets its own stereo buffer when rendering on several threads,
+    // with the buffers rounded up to whole cache lines
+    if (renderThreads > 0 && VoiceBank<MAX_VOICES>::NUM_GROUPS > 1)
+    {
+        groupBufferStride = (maxBlockSize + 15) & ~15;
+        groupBuffers.resize(size_t(VoiceBank<MAX_VOICES>::NUM_GROUPS * 2 * groupBufferStride));
+        renderPool.start(renderThreads);
+    }
+    else
+    {
+        groupBuffers = {};
+        renderPool.stop();
+    }
+}
+
+void Synth::deallocateResources()
+{
+    renderPool.stop();
+    groupBuffers = {};
+    noiseBuffer = {};
+    voiceNoiseBuffer = {};
+    monoBuffer = {};
+    oversampledLeft = {};
+    oversampledRight = {};
+    controlChunks = {};
+    for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
+    {
+        voices[voiceIndex].allocateResources(0);
+    }
+}
+
+void Synth::setRenderThreads(const int numThreads)
+{
+    renderThreads = std::max(numThreads, 0);
+}
+
+void Synth::setControlInterval(const int samples)
+{
+    nextControlInterval = std::max(samples, 1);
+}
+
+void Synth::setOversampling(const int factor)
+{
+    nextOversampling = (factor >= 4) ? 4 : ((factor >= 2) ? 2 : 1);
+}
+
+void Synth::setNoiseColour(const NoiseColour colour)
+{
+    noise.setColour(colour);
+    for (auto& lanes : voiceNoise)
+    {
+        lanes.setColour(colour);
     }
 }
 
-void Synth::deallocateResources() const
+void Synth::setNoisePerVoice(const bool perVoice)
 {
-    // Currently not implemented. It will be once the components are together.
+    nextNoisePerVoice = perVoice;
 }
 
 void Synth::reset()
 {
     lfo = 0.0f;
-    lfoStep = 0;
+    controlStep = 0;
+    vibratoMod = 1.0f;
+    outputGain.reset();
+    noiseGain.reset();
+    for (auto& decimator : decimators)
+    {
+        decimator.reset();
+    }
 
     for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex) 
     {
         voices[voiceIndex].reset();
     }
 
+    activeVoices.clearAll();
+    voiceAllocator.reset();
     noise.reset();
+    for (int group = 0; group < VoiceBank<MAX_VOICES>::NUM_GROUPS; ++group)
+    {
+        voiceNoise[size_t(group)].reset(group * VoiceBank<MAX_VOICES>::LANE_WIDTH);
+    }
     pitchBend = 1.0f; // Give this a value as it isn't received if the user doesn't touch the pitch bend
     sustainPedalPressed = false;
 }
@@ -47,62 +152,213 @@ void Synth::render(float** outputBuffers, int sampleCount)
     float* outputBufferLeft = outputBuffers[0];
     float* outputBufferRight = outputBuffers[1];
 
-    // set up oscillator periods
-    for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
+    // the scratch buffers hold maxBlockSize samples, so render longer blocks in pieces
+    const int maxSegmentSize = maxBlockSize / oversampling;
+    for (int offset = 0; offset < sampleCount; offset += maxSegmentSize)
     {
-        Voice& voice = voices[voiceIndex];
-        // if (voice.env.isActive())
+        float* left = outputBufferLeft + offset;
+        float* right = (outputBufferRight != nullptr) ? outputBufferRight + offset : nullptr;
+        const int segmentSampleCount = std::min(maxSegmentSize, sampleCount - offset);
+
+        if (oversampling == 1)
+        {
+            renderSegment(left, right, segmentSampleCount);
+            continue;
+        }
 
+        // render the voices at the higher rate and bring them back down to the host's
+        renderSegment(oversampledLeft.data(), (right != nullptr) ? oversampledRight.data() : nullptr,
+            segmentSampleCount * oversampling);
+        decimators[0].process(oversampledLeft.data(), left, segmentSampleCount);
+        if (right != nullptr)
+        {
+            decimators[1].process(oversampledRight.data(), right, segmentSampleCount);
+        }
+    }
+}
+
+void Synth::renderSegment(float* outputBufferLeft, float* outputBufferRight, const int sampleCount)
+{
+    // set up oscillator periods
+    activeVoices.forEach([this] (const int voiceIndex) {
+        Voice& voice = voices[voiceIndex];
         voice.oscillator.period = voice.period * pitchBend;
         voice.oscillator2.period = voice.period * detune;
-        
+    });
+
+    // level changes are ramped rather than jumped to
+    const int smoothingSamples = int(SMOOTHING_TIME * sampleRate);
+    const float noiseLevel = noiseMix * noiseScale;
+    if (noiseLevel != noiseGain.getTarget()) { noiseGain.setTarget(noiseLevel, smoothingSamples); }
+    if (outputLevel != outputGain.getTarget()) { outputGain.setTarget(outputLevel, smoothingSamples); }
+
+    // get next noise samples, one stream for every voice or a stream each for the groups that are sounding
+    if (noisePerVoice)
+    {
+        constexpr int lanes = VoiceBank<MAX_VOICES>::LANE_WIDTH;
+        for (int group = 0; group < VoiceBank<MAX_VOICES>::NUM_GROUPS; ++group)
+        {
+            if (!activeVoices.anyInRange(group * lanes, lanes)) { continue; }
+            float* groupNoise = voiceNoiseBuffer.data() + size_t(group * voiceNoiseStride);
+            voiceNoise[size_t(group)].fill(groupNoise, sampleCount);
+            noiseGain.applyGain(groupNoise, sampleCount, lanes);
+        }
+    }
+    else
+    {
+        noise.fill(noiseBuffer.data(), sampleCount);
+        noiseGain.applyGain(noiseBuffer.data(), sampleCount);
     }
-    // Loop through samples
-    for (int sample = 0; sample < sampleCount; ++ sample) {
-        // update the LFO
-        updateLFO();
+    noiseGain.advance(sampleCount);
 
-        // get next noise sample
-        auto noiseSample = noise.nextValue() * noiseMix;
+    // work out where the control updates fall in this block
+    numControlChunks = planControlChunks(sampleCount);
 
-        // make sure note is being played, then apply velocity
-        float outputSampleLeft = 0.0f;
-        auto outputSampleRight = outputSampleLeft;
+    // in mono, render the right channel to a scratch buffer and mix it into the left
+    float* left = outputBufferLeft;
+    float* right = (outputBufferRight != nullptr) ? outputBufferRight : monoBuffer.data();
+    std::fill(left, left + sampleCount, 0.0f);
+    std::fill(right, right + sampleCount, 0.0f);
 
-        for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
+    // With more than one voice sounding, render them from the voice bank and copy the state back
+    // at the end. A lone voice is cheaper to render on its own, a block at a time.
+    const int numActiveVoices = activeVoices.count();
+    if (numActiveVoices == 1)
+    {
+        const int voiceIndex = activeVoices.first();
+        Voice& voice = voices[voiceIndex];
+        if (noisePerVoice)
         {
-            Voice& voice = voices[voiceIndex];
-            if (voice.env.isActive()) 
+            // the voice's own stream, picked out of its group's frames
+            constexpr int lanes = VoiceBank<MAX_VOICES>::LANE_WIDTH;
+            const float* groupNoise = voiceNoiseBuffer.data() + size_t((voiceIndex / lanes) * voiceNoiseStride);
+            for (int i = 0; i < sampleCount; ++i)
             {
-                // get next oscillator samples and pan
-                float outputSample = voice.render(noiseSample);
-                outputSampleLeft += outputSample * voice.panLeft;
-                outputSampleRight += outputSample * voice.panRight;
-
-                outputSampleLeft *= outputLevel;
-                outputSampleRight *= outputLevel;
+                noiseBuffer[size_t(i)] = groupNoise[i * lanes + voiceIndex % lanes];
             }
         }
-         // copy output to each channel, only applying to left if we're in mono
-        if (outputBufferRight != nullptr) 
+        const float inverseInterval = 1.0f / float(controlInterval);
+        for (int chunk = 0; chunk < numControlChunks; ++chunk)
         {
-            outputBufferLeft[sample] = outputSampleLeft;
-            outputBufferRight[sample] = outputSampleRight;
-        } else {
-            outputBufferLeft[sample] = (outputSampleLeft + outputSampleRight) * 0.5f;
+            const ControlChunk& controlChunk = controlChunks[size_t(chunk)];
+            if (controlChunk.controlUpdate && voice.env.isActive())
+            {
+                voice.oscillator.modulationStep = (controlChunk.vibratoMod - voice.oscillator.modulation) * inverseInterval;
+                voice.oscillator2.modulationStep = (controlChunk.vibratoMod - voice.oscillator2.modulation) * inverseInterval;
+            }
+            voice.renderBlock(left + controlChunk.start, right + controlChunk.start,
+                noiseBuffer.data() + controlChunk.start, controlChunk.size);
         }
     }
-    for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
+    else if (numActiveVoices > 1)
+    {
+        voiceBank.load(voices, activeVoices);
+        renderVoiceGroups(left, right, sampleCount);
+        voiceBank.store(voices);
+    }
+
+    outputGain.applyGain(left, sampleCount);
+    outputGain.applyGain(right, sampleCount);
+    outputGain.advance(sampleCount);
+    if (outputBufferRight == nullptr)
+    {
+        for (int i = 0; i < sampleCount; ++i)
         {
-            Voice& voice = voices[voiceIndex];
-            if (!voice.env.isActive()) {
-                voice.env.reset();
-            }
+            left[i] = (left[i] + right[i]) * 0.5f;
         }
+    }
 
+    // voices whose envelope finished during this block are now idle
+    activeVoices.forEach([this] (const int voiceIndex) {
+        Voice& voice = voices[voiceIndex];
+        if (!voice.env.isActive()) {
+            voice.env.reset();
+            activeVoices.clear(voiceIndex);
+            voiceAllocator.voiceFinished(voiceIndex);
+        }
+    });
+}
 
-    protectYourEars(outputBufferLeft,sampleCount);
-    protectYourEars(outputBufferRight,sampleCount);
+void Synth::renderVoiceGroups(float* left, float* right, const int sampleCount)
+{
+    numGroupsToRender = 0;
+    for (int group = 0; group < VoiceBank<MAX_VOICES>::NUM_GROUPS; ++group)
+    {
+        if (voiceBank.isLoaded(group)) { groupsToRender[size_t(numGroupsToRender++)] = group; }
+    }
+
+    if (renderPool.getNumWorkers() == 0 || numGroupsToRender < 2)
+    {
+        for (int i = 0; i < numGroupsToRender; ++i)
+        {
+            renderVoiceGroup(groupsToRender[size_t(i)], left, right);
+        }
+        return;
+    }
+
+    // Render each group into its own buffer on the worker threads, then add them up in order
+    // so the result is the same as rendering them one after the other
+    segmentSize = sampleCount;
+    renderPool.run(renderGroupTask, this, numGroupsToRender);
+
+    for (int i = 0; i < numGroupsToRender; ++i)
+    {
+        const float* groupLeft = groupBuffers.data() + size_t(2 * i * groupBufferStride);
+        const float* groupRight = groupLeft + groupBufferStride;
+        for (int sample = 0; sample < sampleCount; ++sample)
+        {
+            left[sample] += groupLeft[sample];
+            right[sample] += groupRight[sample];
+        }
+    }
+}
+
+void Synth::renderGroupTask(void* context, const int taskIndex)
+{
+    auto& synth = *static_cast<Synth*>(context);
+    float* groupLeft = synth.groupBuffers.data() + size_t(2 * taskIndex * synth.groupBufferStride);
+    float* groupRight = groupLeft + synth.groupBufferStride;
+    std::fill(groupLeft, groupLeft + synth.segmentSize, 0.0f);
+    std::fill(groupRight, groupRight + synth.segmentSize, 0.0f);
+    synth.renderVoiceGroup(synth.groupsToRender[size_t(taskIndex)], groupLeft, groupRight);
+}
+
+void Synth::renderVoiceGroup(const int group, float* left, float* right)
+{
+    // Only touches this group's lanes in the voice bank, so groups can be rendered in parallel
+    for (int chunk = 0; chunk < numControlChunks; ++chunk)
+    {
+        const ControlChunk& controlChunk = controlChunks[size_t(chunk)];
+        if (controlChunk.controlUpdate)
+        {
+            voiceBank.loadFilterCoefficients(group, voices);
+            voiceBank.setModulation(group, controlChunk.vibratoMod, controlInterval);
+        }
+        const float* groupNoise = noisePerVoice
+            ? voiceNoiseBuffer.data() + size_t(group * voiceNoiseStride + controlChunk.start * VoiceBank<MAX_VOICES>::LANE_WIDTH)
+            : noiseBuffer.data() + controlChunk.start;
+        voiceBank.renderGroup(group, left + controlChunk.start, right + controlChunk.start,
+            groupNoise, controlChunk.size, noisePerVoice);
+    }
+}
+
+int Synth::planControlChunks(const int sampleCount)
+{
+    // The modulation updates every controlInterval samples,
+    // so split the block into chunks that start at an update
+    int numChunks = 0;
+    int sample = 0;
+    while (sample < sampleCount)
+    {
+        ControlChunk& chunk = controlChunks[size_t(numChunks++)];
+        chunk.start = sample;
+        chunk.controlUpdate = --controlStep <= 0;
+        if (chunk.controlUpdate) { chunk.vibratoMod = updateLFO(); }
+        chunk.size = std::min(controlStep, sampleCount - sample);
+        controlStep -= chunk.size - 1;
+        sample += chunk.size;
+    }
+    return numChunks;
 }
 
 
@@ -140,9 +396,8 @@ void Synth::midiMessages(uint8_t data0, uint8_t data1, uint8_t data2)
         // Pitch bend message
         case 0xE0:
         // Pitch bend message (0xE0-0xEF)
-            pitchBend = std::exp(-0.000014102f * float(data1 + 128 * data2 - 8192));
-            // magic number: 0.000014102 = log(2^(-2/8192)/12)
             // pitch bend takes values between 0.89 and 1.12
+            pitchBend = pitchBendRatio(data1, data2);
             break;
         
         case 0xB0:
@@ -155,41 +410,40 @@ void Synth::midiMessages(uint8_t data0, uint8_t data1, uint8_t data2)
     }
 }
 
-void Synth::updateLFO() // TODO: Comment me!
+float Synth::updateLFO()
 {
-    if (--lfoStep <= 0 )
-    {
-        lfoStep = LFO_MAX;
-
-        lfo += lfoInc;
-        if (lfo > PI) { lfo -= TWO_PI; }
-        const float sine = std::sin(lfo);
-        // TODO: Remove hardcoding!
-        float vibratoMod = 1.0f + sine * 0.1f;
-
-        for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
-        {
-            Voice& voice = voices[voiceIndex];
-            voice.filter.updateCoefficients (1000.0f,0.707f);
-            if (voice.env.isActive())
-            {
-                voice.oscillator.modulation = vibratoMod;
-                voice.oscillator2.modulation = vibratoMod;
-            }
-        }
-    }
+    // Moves the LFO on by a control interval and works out the modulation the voices
+    // ramp to over the next interval
+    controlStep = controlInterval;
+
+    lfo += lfoInc * float(controlInterval);
+    if (lfo > PI) { lfo -= TWO_PI; }
+    // libm rather than FastMath: this runs once a control interval, and an ulp here builds up as phase
+    const float sine = std::sin(lfo);
+    // TODO: Remove hardcoding!
+    vibratoMod = 1.0f + sine * 0.1f;
+
+    // idle voices are brought up to date when they are started
+    activeVoices.forEach([this] (const int voiceIndex) {
+        jx11_Filter& filter = voices[voiceIndex].filter;
+        filter.setCoefficients(filterCoefficients.get(1000.0f, 0.707f, filter.getSampleRate()));
+    });
+
+    // the modulation is applied to the voices as the chunks are rendered
+    return vibratoMod;
 }
 
 
 void Synth::setSampleRate(float inputSampleRate)
 {
-    this->sampleRate = inputSampleRate;
-    this->inverseSampleRate = 1.0f / inputSampleRate;
+    this->sampleRate = inputSampleRate * float(oversampling);
+    this->inverseSampleRate = 1.0f / this->sampleRate;
+    envelopeMultipliers.prepare(this->inverseSampleRate);
 
         for (int voiceIndex = 0; voiceIndex < MAX_VOICES; ++voiceIndex)
         {
             Voice& voice = voices[voiceIndex];
-            voice.setSampleRate(inputSampleRate);
+            voice.setSampleRate(this->sampleRate);
         }
 }
 
@@ -198,21 +452,12 @@ int Synth::findFreeVoice() const
     /**
      * Finds a free voice in the synthesizer.
      *
-     * This algorithm iterates through all voices and returns the index of the first voice that is not active or has finished its attack phase and is at the lowest level.
+     * If any voice is idle, the highest numbered idle voice is used. Otherwise the voice that was released
+     * longest ago is stolen, or if none have been released, the one that started longest ago.
      *
      * @return The index of the free voice.
      */
-    int voice = 0;
-    float l = 100.0f;
-
-    for (int i = 0; i < MAX_VOICES; ++i)
-    { 
-        if ((!voices[i].env.isActive() || voices[i].env.level < l) && !voices[i].env.isInAttack()) {
-            l = voices[i].env.level;
-            voice = i;
-        }
-    }
-    return voice;
+    return voiceAllocator.allocate();
 }
 
 void Synth::noteOn(int note, int velocity)
@@ -228,6 +473,7 @@ void Synth::noteOn(int note, int velocity)
     int voice = 0;
     if (numVoices > 1) {
         voice = findFreeVoice();
+        if (!voiceAllocator.isIdle(voice)) { ++voicesStolen; }
     }
     startVoice(voice, note, velocity);
 }
@@ -252,7 +498,9 @@ void Synth::startVoice(int voiceIndex, int note, int velocity)
     // Automatic Gain Control and Velocity
     volumeTrim = 0.0008f * (3.2f - oscMix - 25.0f * noiseMix) * 1.5f;
     float mappedVelocity = 0.004f *float((velocity + 64) * (velocity +64)) - 8.0f;
-    voice.oscillator.amplitude = volumeTrim * mappedVelocity;
+    // the harmonics of a BLIT are its peak over its period in samples, so an oversampled
+    // oscillator needs a taller peak to be as loud
+    voice.oscillator.amplitude = volumeTrim * mappedVelocity * float(oversampling);
 
     // oscillator 2
     voice.oscillator2.amplitude = voice.oscillator.amplitude * oscMix;
@@ -265,6 +513,15 @@ void Synth::startVoice(int voiceIndex, int note, int velocity)
     voice.env.releaseMultiplier = envRelease;
     
     voice.env.attack();
+
+    // the LFO only updates sounding voices, so bring the modulation and filter up to date
+    voice.oscillator.modulation = vibratoMod;
+    voice.oscillator2.modulation = vibratoMod;
+    voice.oscillator.modulationStep = 0.0f;
+    voice.oscillator2.modulationStep = 0.0f;
+    voice.filter.setCoefficients(filterCoefficients.get(1000.0f, 0.707f, voice.filter.getSampleRate()));
+    activeVoices.set(voiceIndex);
+    voiceAllocator.noteStarted(voiceIndex, note);
 }
 
 // declare unused for now, will come back to this
@@ -277,6 +534,8 @@ void Synth::restartMonoVoice (const int note, [[maybe_unused]] int velocity)
     voice.env.level += SILENCE + SILENCE;
     voice.note = note;
     voice.update();
+    activeVoices.set(0);
+    voiceAllocator.noteStarted(0, note);
 }
 
 void Synth::noteOff(int note)
@@ -286,17 +545,32 @@ void Synth::noteOff(int note)
  * @param note The MIDI note number to turn off.
  */
 {
-    for (int voice = 0; voice < numVoices; ++voice) 
+    // the pedal has come up, so release the notes it was holding
+    if (note == SUSTAIN)
     {
-        if (voices[voice].note == note && sustainPedalPressed)
+        voiceAllocator.forEachSustained([this] (const int voice) {
+            voices[voice].noteOff();
+            voices[voice].note = 0;
+            voiceAllocator.noteReleased(voice);
+        });
+        return;
+    }
+
+    // only voices whose key is down can be released
+    voiceAllocator.forEachHeld(note, [this] (const int voice) {
+        if (voice >= numVoices) { return; }
+
+        if (sustainPedalPressed)
         {
             voices[voice].note = SUSTAIN;
-        } else if (voices[voice].note == note) 
+            voiceAllocator.noteSustained(voice);
+        } else
         {
             voices[voice].noteOff();
             voices[voice].note = 0;
+            voiceAllocator.noteReleased(voice);
         }
-    }
+    });
 }
 
 void Synth::controlChange(uint8_t data1, uint8_t data2)
@@ -315,6 +589,8 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
         if (data1 >= 0x78) {
             for (int voice = 0; voice < numVoices; ++voice) {
                 voices[voice].reset();
+                activeVoices.clear(voice);
+                voiceAllocator.voiceFinished(voice);
             }
             sustainPedalPressed = false;
             }
@@ -331,24 +607,29 @@ float Synth::calculatePeriod (const int voiceIndex, const int note) const
  * @return The period of the note in samples.
  */
 
-// another magic number, this one is equal to log(2^-1/12)
-// This causes a loop if period = 0.
-    float period = tune * std::exp(-0.05776226505f * static_cast<float> (note) + ANALOG * float(voiceIndex));
-// Ensure the period is 6 samples or greater, otherwise the BLIT is unstable
-    while (period < 6.0f || (period * detune) < 6.0f) {period += period; }
+// The drift wraps around so that high voice counts don't detune the top voices
+    float period = tune * NOTE_PERIOD_FACTORS[size_t(voiceIndex % ANALOG_VOICES)][size_t(note & 0x7F)];
+// Ensure the period is 6 samples or greater, otherwise the BLIT is unstable.
+// Doubling is exact, so go straight to the number of octaves doubling until
+// both oscillators reach 6 samples would take: with shortest = m * 2^e and m in
+// [0.5, 1), that's until e reaches 3 if m >= 0.75, since 6 = 0.75 * 2^3, or 4 if not.
+    const float shortest = std::min(period, period * detune);
+    if (shortest < 6.0f) {
+        int exponent = 0;
+        const float mantissa = std::frexp(shortest, &exponent);
+        period = std::ldexp(period, ((mantissa >= 0.75f) ? 3 : 4) - exponent);
+    }
     return period;
 }
 
 float Synth::calculateAttackFromPercentage (const float attackPercentage) const
 {
-    const float calculatedEnvAttack = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * attackPercentage));
-   return calculatedEnvAttack;
+    return envelopeMultipliers(attackPercentage);
 }
 
 float Synth::calculateDecayFromPercentage (const float decayPercentage) const
 {
-    float calculatedEnvDecay = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * decayPercentage));
-    return calculatedEnvDecay;
+    return envelopeMultipliers(decayPercentage);
 }
 
 float Synth::calculateSustainFromPercentage (const float sustainPercentage) const
@@ -363,7 +644,7 @@ float Synth::calculateReleaseFromPercentage (const float releasePercentage) cons
     if (releasePercentage < 1.0f) {
         calculatedEnvRelease = 0.75f; // extra fast release
     } else {
-        calculatedEnvRelease = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * releasePercentage));
+        calculatedEnvRelease = envelopeMultipliers(releasePercentage);
     }
 
     return calculatedEnvRelease;
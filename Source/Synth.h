@@ -23,12 +23,29 @@
 
 #pragma once
 
+#include "ControlRamp.h"
+#include "HalfBandDecimator.h"
 #include "Noise.h"
+#include "ParameterTables.h"
+#include "RenderThreadPool.h"
 #include "Voice.h"
+#include "VoiceAllocator.h"
+#include "VoiceBank.h"
+#include "VoiceMask.h"
 #include <JuceHeader.h>
 #include "Constants.h"
 
 
+// The polyphony is fixed at build time, set with the JX11_MAX_VOICES CMake option
+#ifndef JX11_MAX_VOICES
+    #define JX11_MAX_VOICES 8
+#endif
+
+// How many times the host rate the voices are rendered at, set with the JX11_OVERSAMPLING CMake option
+#ifndef JX11_OVERSAMPLING
+    #define JX11_OVERSAMPLING 1
+#endif
+
 /**
  * @class Synth
  * @brief A synthesizer class that interfaces with the audio processor.
@@ -36,10 +53,16 @@
 class Synth
 {
     public:
-        static const int MAX_VOICES = 8; // number of voices
-        const float ANALOG = 0.002f; // Analog oscillator drift
+        static constexpr int MAX_VOICES = JX11_MAX_VOICES; // number of voices
+        static_assert(MAX_VOICES > 0, "JX11_MAX_VOICES must be at least 1");
+        static constexpr float ANALOG = ANALOG_DRIFT; // Analog oscillator drift
+        static constexpr int ANALOG_VOICES = ANALOG_DRIFT_VOICES; // The drift repeats every this many voices
         const int SUSTAIN = -1;
-        const int LFO_MAX = 32; // LFO update step
+        static constexpr int DEFAULT_CONTROL_INTERVAL = 32; // samples between updates of the LFO and smoothing
+        static constexpr int DEFAULT_OVERSAMPLING = JX11_OVERSAMPLING;
+        static_assert(DEFAULT_OVERSAMPLING == 1 || DEFAULT_OVERSAMPLING == 2 || DEFAULT_OVERSAMPLING == 4,
+                      "JX11_OVERSAMPLING must be 1, 2 or 4");
+        static constexpr float SMOOTHING_TIME = 0.01f; // seconds that level changes are ramped over
 
         /**
          * @brief Default constructor.
@@ -56,7 +79,7 @@ class Synth
         /**
          * @brief Deallocates resources for the synthesizer.
          */
-        void deallocateResources() const;
+        void deallocateResources();
 
         /**
          * @brief Resets the synthesizer to its default state.
@@ -162,7 +185,7 @@ class Synth
         bool ignoreVelocity;
 
         /**
-         * @brief LFO phase increment
+         * @brief LFO phase increment per sample at the rendering rate, in radians
          */
         float lfoInc;
 
@@ -173,17 +196,163 @@ class Synth
         float calculateSustainFromPercentage(float sustainPercentage) const;
         float calculateReleaseFromPercentage(float releasePercentage) const;
 
+        /**
+         * @brief Sets the host sample rate. The voices run at oversampling times this.
+         */
         void setSampleRate(float SampleRate);
 
+        /**
+         * @brief Sets how many worker threads help render the voices, in groups of VoiceBank::LANE_WIDTH.
+         *
+         * With 0 (the default) everything is rendered on the calling thread. The output is the same
+         * either way. Takes effect at the next call to allocateResources, which starts the threads.
+         *
+         * @param numThreads The number of worker threads.
+         */
+        void setRenderThreads(int numThreads);
+
+        /**
+         * @brief Sets how often the modulation is worked out, in samples.
+         *
+         * The LFO and parameter smoothing are evaluated once per interval, and the audio
+         * follows them with linear ramps in between. Shorter intervals track fast modulation
+         * more closely for more CPU. Takes effect at the next call to allocateResources.
+         *
+         * @param samples The number of samples at the host rate between control updates, at least 1.
+         */
+        void setControlInterval(int samples);
+        int getControlInterval() const { return controlInterval / oversampling; }
+
+        /**
+         * @brief Sets how many times the host rate the voices are rendered at: 1, 2 or 4.
+         *
+         * Oversampling keeps the filter and oscillators from aliasing, and lets the BLIT
+         * play high notes without folding them down an octave. The voices are brought back
+         * to the host rate with half-band FIR decimators, which delay the output by
+         * getLatency(). Takes effect at the next call to allocateResources.
+         *
+         * @param factor The oversampling factor. Anything else is rounded down to one of these.
+         */
+        void setOversampling(int factor);
+        int getOversampling() const { return oversampling; }
+
+        /**
+         * @brief Sets whether the noise mixed into the voices is white or pink. Takes effect straight away.
+         */
+        void setNoiseColour(NoiseColour colour);
+        NoiseColour getNoiseColour() const { return noise.getColour(); }
+
+        /**
+         * @brief Sets whether each voice gets its own noise, rather than all of them sharing one stream.
+         *
+         * Independent noise keeps chords from playing the same hiss through every filter. Being
+         * uncorrelated, it also adds up to a lower level when several voices sound. Takes effect at
+         * the next call to allocateResources, which makes room for the streams.
+         *
+         * @param perVoice True for a stream per voice, false for one shared stream (the default).
+         */
+        void setNoisePerVoice(bool perVoice);
+        bool getNoisePerVoice() const { return noisePerVoice; }
+
+        /**
+         * @brief The number of voices sounding.
+         */
+        int getActiveVoiceCount() const { return activeVoices.count(); }
+
+        /**
+         * @brief How many notes have taken a voice that was still sounding, since the synth was made.
+         */
+        uint64_t getVoicesStolen() const { return voicesStolen; }
+
+        /**
+         * @brief The delay added by oversampling, in samples at the host rate.
+         */
+        float getLatency() const { return decimators[0].getLatency(); }
+
     private:
-        float sampleRate;
+        float sampleRate; ///< The rate the voices are rendered at, oversampling times the host rate
         float inverseSampleRate;
         float lfo;
-        int lfoStep;
+        int controlStep; ///< Samples until the next control update
+        int controlInterval = DEFAULT_CONTROL_INTERVAL; ///< In samples at the rendering rate
+        int nextControlInterval = DEFAULT_CONTROL_INTERVAL;
+        int oversampling = DEFAULT_OVERSAMPLING;
+        int nextOversampling = DEFAULT_OVERSAMPLING;
+        float noiseScale = 1.0f; ///< Keeps the noise level the same in the audible band when oversampling
+        float vibratoMod = 1.0f; ///< The modulation the voices are ramping towards
         bool sustainPedalPressed;
-        Noise noise;
+        Noise noise; ///< The stream shared by the voices
+        bool noisePerVoice = false;
+        bool nextNoisePerVoice = false;
+
+        /**
+         * @brief Holds the per-sample voice state while a block is rendered.
+         */
+        VoiceBank<MAX_VOICES> voiceBank;
+
+        /**
+         * @brief The voices whose envelopes are sounding. Idle voices are skipped when rendering.
+         */
+        VoiceMask<MAX_VOICES> activeVoices;
+
+        /**
+         * @brief Which voice plays which note, and which to steal, so MIDI events don't search the voices.
+         */
+        VoiceAllocator<MAX_VOICES> voiceAllocator;
+        uint64_t voicesStolen = 0;
+
+        /**
+         * @brief Filter coefficients shared by the voices, so each cutoff is only calculated once.
+         */
+        FilterCoefficientCache filterCoefficients;
+
+        EnvelopeMultipliers envelopeMultipliers; ///< The envelope settings at the rendering rate
+
+        ControlRamp outputGain; ///< Smooths changes to outputLevel
+        ControlRamp noiseGain; ///< Smooths changes to noiseMix
+
+        std::vector<float> noiseBuffer; ///< Noise for the chunk being rendered
+
+        /**
+         * @brief A noise stream per voice, a generator for each voice group.
+         */
+        std::array<NoiseLanes<VoiceBank<MAX_VOICES>::LANE_WIDTH>, VoiceBank<MAX_VOICES>::NUM_GROUPS> voiceNoise;
+        std::vector<float> voiceNoiseBuffer; ///< Each group's noise as frames of LANE_WIDTH, one group after another
+        int voiceNoiseStride = 0;
+        std::vector<float> monoBuffer; ///< Right channel scratch when the output is mono
+        std::vector<float> oversampledLeft; ///< The voices at the rendering rate, before decimation
+        std::vector<float> oversampledRight;
+        std::array<Decimator, 2> decimators; ///< One per output channel
+
+        /**
+         * @brief A run of samples between control updates.
+         */
+        struct ControlChunk
+        {
+            int start = 0;
+            int size = 0;
+            bool controlUpdate = false; ///< Whether the modulation updates at the start of the chunk
+            float vibratoMod = 1.0f; ///< The modulation to ramp to, if it updates
+        };
+
+        std::vector<ControlChunk> controlChunks;
+        int numControlChunks = 0;
+        int maxBlockSize = 0; ///< The longest segment, in samples at the rendering rate
+
+        int renderThreads = 0;
+        RenderThreadPool renderPool;
+        std::vector<float> groupBuffers; ///< A stereo pair per voice group, for rendering on several threads
+        int groupBufferStride = 0;
+        std::array<int, VoiceBank<MAX_VOICES>::NUM_GROUPS> groupsToRender {};
+        int numGroupsToRender = 0;
+        int segmentSize = 0;
 
-        void updateLFO();
+        void renderSegment(float* outputBufferLeft, float* outputBufferRight, int sampleCount);
+        void renderVoiceGroups(float* left, float* right, int sampleCount);
+        void renderVoiceGroup(int group, float* left, float* right);
+        static void renderGroupTask(void* context, int taskIndex);
+        int planControlChunks(int sampleCount);
+        float updateLFO();
         int findFreeVoice() const;
         void noteOn(int note,int velocity);
         void startVoice(int voiceIndex, int note, int velocity);
@@ -0,0 +1,102 @@
+#include "SynthParameters.h"
+
+bool SynthParameters::set(const std::string_view id, const float value)
+{
+    for (const auto& entry : entries) {
+        if (id == entry.id) {
+            this->*entry.value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+SynthParameters::ChangeMask SynthParameters::differences(const SynthParameters& other) const
+{
+    ChangeMask changed = 0;
+    for (size_t index = 0; index < entries.size(); ++index) {
+        if (this->*entries[index].value != other.*entries[index].value) {
+            changed |= ChangeMask(1) << index;
+        }
+    }
+    return changed;
+}
+
+void SynthParameters::applyTo(Synth& synth, const float sampleRate, const ChangeMask changed) const
+{
+    const auto anyChanged = [changed] (const ChangeMask parameters) { return (changed & parameters) != 0; };
+    // periods and increments are per sample at the rate the voices run at
+    const float renderSampleRate = sampleRate * float(synth.getOversampling());
+
+    // everything that depends on the sample rate is recalculated when every parameter is
+    if (changed == ALL_CHANGED) {
+        synth.setSampleRate(sampleRate);
+    }
+
+    // updating ADSR TODO: tidy this up
+    if (anyChanged(maskOf(&SynthParameters::envAttack))) {
+        synth.envAttack = synth.calculateAttackFromPercentage(envAttack);
+    }
+    if (anyChanged(maskOf(&SynthParameters::envDecay))) {
+        synth.envDecay = synth.calculateDecayFromPercentage(envDecay);
+    }
+    if (anyChanged(maskOf(&SynthParameters::envSustain))) {
+        synth.envSustain = synth.calculateSustainFromPercentage(envSustain);
+    }
+    if (anyChanged(maskOf(&SynthParameters::envRelease))) {
+        synth.envRelease = synth.calculateReleaseFromPercentage(envRelease);
+    }
+
+    // Oscillators
+    if (anyChanged(maskOf(&SynthParameters::oscMix))) {
+        synth.oscMix = oscMix / 100.0f;
+    }
+    if (anyChanged(maskOf(&SynthParameters::oscTune) | maskOf(&SynthParameters::oscFine))) {
+        synth.detune = std::pow(1.059463094359f, -oscTune - 0.01f * oscFine);
+        // This is equivalent to std::exp2((-semi - 0.01f * cent) / 12.0f)
+    }
+
+    // Synth tuning
+    if (anyChanged(maskOf(&SynthParameters::octave) | maskOf(&SynthParameters::tuning))) {
+        float tuneInSemi = -36.3763f - 12.0f * octave - tuning / 100.0f;
+        synth.tune = renderSampleRate * std::exp(0.05776226505f * tuneInSemi);
+    }
+
+    // Poly/Mono
+    if (anyChanged(maskOf(&SynthParameters::polyMode))) {
+        synth.numVoices = (polyMode == 0) ? 1 : synth.MAX_VOICES;
+    }
+
+    // Lfo parameters
+    if (anyChanged(maskOf(&SynthParameters::lfoRate))) {
+        float lfoHz = std::exp(7.0f * lfoRate - 4.0f);
+        synth.lfoInc = lfoHz / renderSampleRate * static_cast<float>(TWO_PI);
+    }
+
+    if (anyChanged(maskOf(&SynthParameters::noise))) {
+        float noiseCopy = noise / 100.0f;
+        noiseCopy *= noiseCopy;
+        synth.noiseMix = noiseCopy * 0.06f;
+    }
+
+    if (anyChanged(maskOf(&SynthParameters::oscMix) | maskOf(&SynthParameters::noise))) {
+        synth.volumeTrim = 0.0008f * (3.2f - synth.oscMix - 25.0f * synth.noiseMix) * 1.5f;
+        // This formula comes from the JX10, and why it was chosen is unknown, but it works for automatic gain control.
+        // I may want to move this to the synth engine
+    }
+
+    // decibels to gain, silent at -100 dB and below
+    if (anyChanged(maskOf(&SynthParameters::outputLevel))) {
+        synth.outputLevel = (outputLevel > -100.0f) ? std::pow(10.0f, outputLevel * 0.05f) : 0.0f;
+    }
+
+    if (anyChanged(maskOf(&SynthParameters::filterVelocity))) {
+        if (filterVelocity < -90.0f) {
+            synth.velocitySensitivity = 0.0f;
+            synth.ignoreVelocity = true;
+        } else {
+            synth.velocitySensitivity = 0.0005f * filterVelocity;
+            synth.ignoreVelocity = false;
+        }
+    }
+}
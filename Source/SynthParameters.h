@@ -0,0 +1,150 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file SynthParameters.h
+* @author CS Islay
+* @brief The plugin's parameter values, and how they map onto the synth engine.
+*
+* Holds the raw parameter values as the plugin shows them (percentages,
+* semitones, decibels) so that the plugin and the offline renderer set up
+* the synth in exactly the same way.
+******************************************************************/
+
+#pragma once
+
+#include "Synth.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+struct SynthParameters
+{
+    float polyMode = 1.0f;
+    float oscTune = -12.0f;
+    float oscFine = 0.0f;
+    float oscMix = 0.0f;
+    float glideMode = 0.0f;
+    float glideRate = 35.0f;
+    float glideBend = 0.0f;
+    float filterFreq = 100.0f;
+    float filterReso = 15.0f;
+    float filterEnv = 50.0f;
+    float filterLFO = 0.0f;
+    float filterVelocity = 0.0f;
+    float filterAttack = 0.0f;
+    float filterDecay = 30.0f;
+    float filterSustain = 0.0f;
+    float filterRelease = 1500.0f;
+    float envAttack = 0.0f;
+    float envDecay = 50.0f;
+    float envSustain = 100.0f;
+    float envRelease = 30.0f;
+    float lfoRate = 0.81f;
+    float vibrato = 0.0f;
+    float noise = 0.0f;
+    float octave = 0.0f;
+    float tuning = 0.0f;
+    float outputLevel = 0.0f;
+
+    /**
+     * @brief A parameter ID and the member that holds its value.
+     */
+    struct Entry
+    {
+        const char* id;
+        float SynthParameters::* value;
+    };
+
+    static constexpr int COUNT = 26;
+
+    /**
+     * @brief Every parameter, by the ID used in the plugin's parameter tree.
+     */
+    static const std::array<Entry, COUNT> entries;
+
+    /**
+     * @brief A set of parameters, with bit i for entries[i].
+     */
+    using ChangeMask = uint32_t;
+    static_assert(COUNT <= 32, "every parameter needs a bit in a ChangeMask");
+    static constexpr ChangeMask ALL_CHANGED = (ChangeMask(1) << COUNT) - 1;
+
+    /**
+     * @brief The bit in a ChangeMask for one parameter.
+     */
+    static constexpr ChangeMask maskOf(float SynthParameters::* value);
+
+    /**
+     * @brief Sets a parameter by its ID.
+     * @return false if there is no parameter with that ID.
+     */
+    bool set(std::string_view id, float value);
+
+    /**
+     * @brief Finds the parameters whose values differ from another set.
+     */
+    ChangeMask differences(const SynthParameters& other) const;
+
+    /**
+     * @brief Sets up the synth for these parameter values.
+     *
+     * Only the synth settings that depend on the changed parameters are worked out again.
+     * Pass ALL_CHANGED the first time, and whenever the sample rate changes.
+     *
+     * @param synth The synth to update.
+     * @param sampleRate The host sample rate. The synth's oversampling is applied on top.
+     * @param changed The parameters that changed since the synth was last updated.
+     */
+    void applyTo(Synth& synth, float sampleRate, ChangeMask changed = ALL_CHANGED) const;
+};
+
+inline constexpr std::array<SynthParameters::Entry, SynthParameters::COUNT> SynthParameters::entries {{
+    { "polyMode", &SynthParameters::polyMode },
+    { "oscTune", &SynthParameters::oscTune },
+    { "oscFine", &SynthParameters::oscFine },
+    { "oscMix", &SynthParameters::oscMix },
+    { "glideMode", &SynthParameters::glideMode },
+    { "glideRate", &SynthParameters::glideRate },
+    { "glideBend", &SynthParameters::glideBend },
+    { "filterFreq", &SynthParameters::filterFreq },
+    { "filterReso", &SynthParameters::filterReso },
+    { "filterEnv", &SynthParameters::filterEnv },
+    { "filterLFO", &SynthParameters::filterLFO },
+    { "filterVelocity", &SynthParameters::filterVelocity },
+    { "filterAttack", &SynthParameters::filterAttack },
+    { "filterDecay", &SynthParameters::filterDecay },
+    { "filterSustain", &SynthParameters::filterSustain },
+    { "filterRelease", &SynthParameters::filterRelease },
+    { "envAttack", &SynthParameters::envAttack },
+    { "envDecay", &SynthParameters::envDecay },
+    { "envSustain", &SynthParameters::envSustain },
+    { "envRelease", &SynthParameters::envRelease },
+    { "lfoRate", &SynthParameters::lfoRate },
+    { "vibrato", &SynthParameters::vibrato },
+    { "noise", &SynthParameters::noise },
+    { "octave", &SynthParameters::octave },
+    { "tuning", &SynthParameters::tuning },
+    { "outputLevel", &SynthParameters::outputLevel },
+}};
+
+constexpr SynthParameters::ChangeMask SynthParameters::maskOf(float SynthParameters::* value)
+{
+    for (size_t index = 0; index < entries.size(); ++index) {
+        if (entries[index].value == value) { return ChangeMask(1) << index; }
+    }
+    return 0;
+}
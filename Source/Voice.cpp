@@ -16,6 +16,37 @@ float Voice::render(float input)
     return outputSample * envelopeSample;
 }
 
+void Voice::renderBlock(float* left, float* right, const float* input, int sampleCount)
+{
+    // the envelope decides how many samples are rendered before the voice goes silent
+    sampleCount = env.renderBlock(envBuffer.data(), sampleCount);
+
+    oscillator.renderBlock(oscBuffer.data(), sampleCount);
+    oscillator2.renderBlock(osc2Buffer.data(), sampleCount);
+
+    float* outputBuffer = oscBuffer.data();
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        outputBuffer[i] = outputBuffer[i] + osc2Buffer[i] + input[i];
+    }
+
+    filter.renderBlock(outputBuffer, sampleCount);
+
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        const float outputSample = outputBuffer[i] * envBuffer[i];
+        left[i] += outputSample * panLeft;
+        right[i] += outputSample * panRight;
+    }
+}
+
+void Voice::allocateResources(const int maxBlockSize)
+{
+    oscBuffer.resize(size_t(maxBlockSize));
+    osc2Buffer.resize(size_t(maxBlockSize));
+    envBuffer.resize(size_t(maxBlockSize));
+}
+
 void Voice::reset()
 {
     note = 0;
@@ -31,6 +31,7 @@
 #include "jx11_Filter.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 class Voice
 {
@@ -53,4 +54,29 @@ class Voice
         void update();
         float render(float input);
         void setSampleRate(float sampleRate);
+
+        /**
+         * @brief Sizes the scratch buffers used by renderBlock.
+         * @param maxBlockSize The largest block renderBlock will be asked for.
+         */
+        void allocateResources(int maxBlockSize);
+
+        /**
+         * @brief Renders a block one stage at a time and adds it, panned, to the outputs.
+         *
+         * Produces the same samples as calling render() while the envelope is active, apart from
+         * the small drift between the envelope's closed form and its per-sample recurrence
+         * described at ADSREnvelope::renderBlock.
+         *
+         * @param left The left output to add to.
+         * @param right The right output to add to.
+         * @param input The input (noise) samples, mixed in before the filter.
+         * @param sampleCount The number of samples, up to the size given to allocateResources.
+         */
+        void renderBlock(float* left, float* right, const float* input, int sampleCount);
+
+    private:
+        std::vector<float> oscBuffer;
+        std::vector<float> osc2Buffer;
+        std::vector<float> envBuffer;
 };
\ No newline at end of file
@@ -0,0 +1,218 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file VoiceAllocator.h
+* @author CS Islay
+* @brief Keeps track of which voice plays which note, so note ons, note
+*        offs and the sustain pedal don't have to search the voices.
+*
+* Each busy voice is in one of three states:
+*
+* - Held: the key is down. Listed under its note.
+* - Sustained: the key is up but the pedal holds the note.
+* - Released: the envelope is in its release.
+*
+* Held and sustained voices are kept in one list in the order they were
+* started, and released voices in another in the order they were released,
+* both linked through arrays indexed by voice. When every voice is busy the
+* oldest released voice is stolen, as it's the quietest, and only if none
+* are released the oldest sounding one. Every change is O(1), and finding
+* an idle voice or the voices playing a note is a scan of one bit per voice.
+*****************************************************************************/
+
+#pragma once
+#include "VoiceMask.h"
+#include <array>
+#include <cstdint>
+
+template <int NumVoices>
+class VoiceAllocator
+{
+public:
+    static constexpr int NUM_NOTES = 128;
+
+    /**
+     * @brief Makes every voice idle.
+     */
+    void reset()
+    {
+        busy.clearAll();
+        sustained.clearAll();
+        for (auto& voices : noteVoices) { voices.clearAll(); }
+        states.fill(State::Idle);
+        held = {};
+        released = {};
+    }
+
+    /**
+     * @brief Finds a voice for a new note: the highest numbered idle voice, or if
+     * there are none, the voice to steal.
+     */
+    int allocate() const
+    {
+        const int idleVoice = busy.lastClear();
+        if (idleVoice >= 0) { return idleVoice; }
+        if (released.head >= 0) { return released.head; }
+        return (held.head >= 0) ? held.head : 0;
+    }
+
+    /**
+     * @brief Records that a voice has started a note, whatever it was doing before.
+     */
+    void noteStarted(const int voiceIndex, const int note)
+    {
+        remove(voiceIndex);
+        states[size_t(voiceIndex)] = State::Held;
+        notes[size_t(voiceIndex)] = note;
+        noteVoices[size_t(note)].set(voiceIndex);
+        busy.set(voiceIndex);
+        append(held, voiceIndex);
+    }
+
+    /**
+     * @brief Calls a function with each voice whose key for a note is still down.
+     *
+     * The function may sustain, release or finish the voice it is given.
+     */
+    template <typename Function>
+    void forEachHeld(const int note, Function&& function) const
+    {
+        noteVoices[size_t(note)].forEach(function);
+    }
+
+    /**
+     * @brief Calls a function with each voice held by the sustain pedal.
+     *
+     * The function may release or finish the voice it is given.
+     */
+    template <typename Function>
+    void forEachSustained(Function&& function) const
+    {
+        sustained.forEach(function);
+    }
+
+    /**
+     * @brief Records that a held voice's key has come up while the pedal is down.
+     */
+    void noteSustained(const int voiceIndex)
+    {
+        if (states[size_t(voiceIndex)] != State::Held) { return; }
+        noteVoices[size_t(notes[size_t(voiceIndex)])].clear(voiceIndex);
+        sustained.set(voiceIndex);
+        states[size_t(voiceIndex)] = State::Sustained;
+    }
+
+    /**
+     * @brief Records that a voice has gone into its release.
+     */
+    void noteReleased(const int voiceIndex)
+    {
+        if (states[size_t(voiceIndex)] == State::Idle || states[size_t(voiceIndex)] == State::Released) { return; }
+        remove(voiceIndex);
+        states[size_t(voiceIndex)] = State::Released;
+        busy.set(voiceIndex);
+        append(released, voiceIndex);
+    }
+
+    /**
+     * @brief Records that a voice has gone silent.
+     */
+    void voiceFinished(const int voiceIndex)
+    {
+        remove(voiceIndex);
+    }
+
+    bool isIdle(const int voiceIndex) const { return states[size_t(voiceIndex)] == State::Idle; }
+    bool isHeld(const int voiceIndex) const { return states[size_t(voiceIndex)] == State::Held; }
+    bool isSustained(const int voiceIndex) const { return states[size_t(voiceIndex)] == State::Sustained; }
+    bool isReleased(const int voiceIndex) const { return states[size_t(voiceIndex)] == State::Released; }
+
+private:
+    enum class State : uint8_t
+    {
+        Idle,
+        Held,
+        Sustained,
+        Released
+    };
+
+    /**
+     * @brief A list of voices, oldest first, linked through previous and next.
+     */
+    struct List
+    {
+        int head = -1;
+        int tail = -1;
+    };
+
+    VoiceMask<NumVoices> busy;
+    VoiceMask<NumVoices> sustained;
+    std::array<VoiceMask<NumVoices>, NUM_NOTES> noteVoices {};
+    std::array<State, NumVoices> states = makeIdleStates();
+    std::array<int, NumVoices> notes {};
+    std::array<int, NumVoices> previous {};
+    std::array<int, NumVoices> next {};
+    List held; ///< Held and sustained voices, in the order they started
+    List released; ///< Released voices, in the order they were released
+
+    static std::array<State, NumVoices> makeIdleStates()
+    {
+        std::array<State, NumVoices> idle;
+        idle.fill(State::Idle);
+        return idle;
+    }
+
+    void append(List& list, const int voiceIndex)
+    {
+        previous[size_t(voiceIndex)] = list.tail;
+        next[size_t(voiceIndex)] = -1;
+        if (list.tail >= 0) { next[size_t(list.tail)] = voiceIndex; } else { list.head = voiceIndex; }
+        list.tail = voiceIndex;
+    }
+
+    void unlink(List& list, const int voiceIndex)
+    {
+        const int before = previous[size_t(voiceIndex)];
+        const int after = next[size_t(voiceIndex)];
+        if (before >= 0) { next[size_t(before)] = after; } else { list.head = after; }
+        if (after >= 0) { previous[size_t(after)] = before; } else { list.tail = before; }
+    }
+
+    /**
+     * @brief Takes a voice out of whichever list and masks it's in, leaving it idle.
+     */
+    void remove(const int voiceIndex)
+    {
+        switch (states[size_t(voiceIndex)]) {
+            case State::Held:
+                noteVoices[size_t(notes[size_t(voiceIndex)])].clear(voiceIndex);
+                unlink(held, voiceIndex);
+                break;
+            case State::Sustained:
+                sustained.clear(voiceIndex);
+                unlink(held, voiceIndex);
+                break;
+            case State::Released:
+                unlink(released, voiceIndex);
+                break;
+            case State::Idle:
+                return;
+        }
+        states[size_t(voiceIndex)] = State::Idle;
+        busy.clear(voiceIndex);
+    }
+};
@@ -0,0 +1,552 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file VoiceBank.h
+* @author CS Islay
+* @brief A structure-of-arrays copy of the voice state used for rendering.
+*
+* The Voice objects are the "control" view of the synth: notes, envelopes and
+* oscillators are set up on them when MIDI arrives. While a block is rendered
+* the per-sample state (oscillator phase, filter integrators, envelope level)
+* lives here instead, one contiguous array per field with one lane per voice.
+* Every stage is a plain loop over the lanes with no branches, so the compiler
+* can render LANE_WIDTH voices per instruction with SSE/AVX/NEON. The envelopes
+* are the exception: they are worked out ahead, up to ENVELOPE_BLOCK samples at a
+* time in closed form, and applied to the filtered voices as a gain.
+*
+* Voices are loaded, rendered and stored in groups of LANE_WIDTH, and groups
+* with no sounding voices are skipped entirely. Each group's lanes are kept
+* together on their own cache lines so groups can be rendered on different
+* threads.
+*
+*****************************************************************************/
+
+#pragma once
+#include "FilterLanes.h"
+#include "Voice.h"
+#include "VoiceMask.h"
+#include <array>
+#include <cmath>
+
+template <int NumVoices>
+class VoiceBank
+{
+public:
+    /**
+     * @brief The number of voices rendered together, sized for an AVX register.
+     */
+    static constexpr int LANE_WIDTH = 8;
+
+    /**
+     * @brief The number of groups of LANE_WIDTH voices.
+     */
+    static constexpr int NUM_GROUPS = (NumVoices + LANE_WIDTH - 1) / LANE_WIDTH;
+
+    /**
+     * @brief Copies the full state of every voice into the lanes.
+     * @param voices The voices to copy from.
+     */
+    void load(const std::array<Voice, NumVoices>& voices)
+    {
+        VoiceMask<NumVoices> allVoices;
+        for (int voiceIndex = 0; voiceIndex < NumVoices; ++voiceIndex) { allVoices.set(voiceIndex); }
+        load(voices, allVoices);
+    }
+
+    /**
+     * @brief Copies the full state of the groups holding sounding voices into the lanes.
+     *
+     * Only these groups are rendered and stored until the next load.
+     *
+     * @param voices The voices to copy from.
+     * @param activeVoices The voices that are sounding.
+     */
+    void load(const std::array<Voice, NumVoices>& voices, const VoiceMask<NumVoices>& activeVoices)
+    {
+        for (int group = 0; group < NUM_GROUPS; ++group)
+        {
+            loadedGroups[group] = activeVoices.anyInRange(group * LANE_WIDTH, LANE_WIDTH);
+            if (!loadedGroups[group]) { continue; }
+
+            Group& g = groups[group];
+            forEachVoiceInGroup(group, [&] (const int i, const int voiceIndex) {
+                const Voice& voice = voices[voiceIndex];
+                loadOscillator(g.oscillator, i, voice.oscillator);
+                loadOscillator(g.oscillator2, i, voice.oscillator2);
+
+                g.filter.load(i, voice.filter);
+
+                g.env.level[i] = voice.env.level;
+                g.env.multiplier[i] = voice.env.multiplier;
+                g.env.target[i] = voice.env.target;
+                g.env.decayMultiplier[i] = voice.env.decayMultiplier;
+                g.env.sustainLevel[i] = voice.env.sustainLevel;
+
+                g.panLeft[i] = voice.panLeft;
+                g.panRight[i] = voice.panRight;
+            });
+        }
+    }
+
+    /**
+     * @brief Checks whether a group was loaded by the last call to load().
+     */
+    bool isLoaded(const int group) const { return loadedGroups[group]; }
+
+    /**
+     * @brief Copies the filter coefficients of the loaded voices into the lanes.
+     * @param voices The voices to copy from.
+     */
+    void loadFilterCoefficients(const std::array<Voice, NumVoices>& voices)
+    {
+        forEachLoadedGroup([&] (const int group) { loadFilterCoefficients(group, voices); });
+    }
+
+    /**
+     * @brief Copies the filter coefficients of the voices in one group into its lanes.
+     * @param group The group to update.
+     * @param voices The voices to copy from.
+     */
+    void loadFilterCoefficients(const int group, const std::array<Voice, NumVoices>& voices)
+    {
+        FilterLanes<LANE_WIDTH>& filter = groups[group].filter;
+        forEachVoiceInGroup(group, [&] (const int i, const int voiceIndex) {
+            filter.loadCoefficients(i, voices[voiceIndex].filter);
+        });
+    }
+
+    /**
+     * @brief Writes the state that changes while rendering back to the loaded voices.
+     * @param voices The voices to copy to.
+     */
+    void store(std::array<Voice, NumVoices>& voices) const
+    {
+        forEachLoadedGroup([&] (const int group) {
+            const Group& g = groups[group];
+            forEachVoiceInGroup(group, [&] (const int i, const int voiceIndex) {
+                Voice& voice = voices[voiceIndex];
+                storeOscillator(g.oscillator, i, voice.oscillator);
+                storeOscillator(g.oscillator2, i, voice.oscillator2);
+
+                g.filter.store(i, voice.filter);
+
+                voice.env.level = g.env.level[i];
+                voice.env.multiplier = g.env.multiplier[i];
+                voice.env.target = g.env.target[i];
+            });
+        });
+    }
+
+    /**
+     * @brief Ramps the oscillator modulation of every sounding voice to a new value.
+     * @param modulation The modulation multiplier applied to the oscillator period.
+     * @param samples The number of samples to ramp over.
+     */
+    void setModulation(const float modulation, const int samples)
+    {
+        forEachLoadedGroup([&] (const int group) { setModulation(group, modulation, samples); });
+    }
+
+    /**
+     * @brief Ramps the oscillator modulation of the sounding voices in one group to a new value.
+     * @param group The group to update.
+     * @param modulation The modulation multiplier applied to the oscillator period.
+     * @param samples The number of samples to ramp over.
+     */
+    void setModulation(const int group, const float modulation, const int samples)
+    {
+        Group& g = groups[group];
+        const float inverseSamples = 1.0f / float(samples);
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            const bool active = g.env.level[i] > SILENCE;
+            const float step = (modulation - g.oscillator.modulation[i]) * inverseSamples;
+            const float step2 = (modulation - g.oscillator2.modulation[i]) * inverseSamples;
+            g.oscillator.modulationStep[i] = active ? step : g.oscillator.modulationStep[i];
+            g.oscillator2.modulationStep[i] = active ? step2 : g.oscillator2.modulationStep[i];
+        }
+    }
+
+    /**
+     * @brief Renders the loaded voices and pans them into a stereo pair.
+     *
+     * Silent voices in a loaded group are computed alongside the others but
+     * their state is left untouched and their output is masked to zero, which
+     * gives the same result as skipping them.
+     *
+     * @param left The left output, overwritten with the sum of the voices.
+     * @param right The right output, overwritten with the sum of the voices.
+     * @param noise The noise input for each sample, shared by all voices.
+     * @param sampleCount The number of samples to render.
+     */
+    void render(float* left, float* right, const float* noise, const int sampleCount)
+    {
+        std::fill(left, left + sampleCount, 0.0f);
+        std::fill(right, right + sampleCount, 0.0f);
+
+        forEachLoadedGroup([&] (const int group) { renderGroup(group, left, right, noise, sampleCount); });
+    }
+
+    /**
+     * @brief Renders one group of voices and adds its mix to the outputs.
+     *
+     * The voices in the group are summed on their own before being added, so
+     * adding the groups to the outputs in ascending order gives the same result
+     * whether the groups were rendered together or into separate buffers.
+     *
+     * @param group The group to render.
+     * @param left The left output to add to.
+     * @param right The right output to add to.
+     * @param noise The noise input: a sample for each sample shared by all voices or, with
+     *              noisePerVoice, a frame of LANE_WIDTH samples for each sample, one per lane.
+     * @param sampleCount The number of samples to render.
+     * @param noisePerVoice Whether each voice has its own noise.
+     */
+    void renderGroup(const int group, float* left, float* right, const float* noise, const int sampleCount,
+                     const bool noisePerVoice = false)
+    {
+        for (int start = 0; start < sampleCount; start += ENVELOPE_BLOCK)
+        {
+            const int count = std::min(ENVELOPE_BLOCK, sampleCount - start);
+            renderGroupBlock(groups[group], left + start, right + start,
+                             noisePerVoice ? noise + start * LANE_WIDTH : noise + start, count, noisePerVoice);
+        }
+    }
+
+private:
+    using Lanes = std::array<float, LANE_WIDTH>;
+
+    /**
+     * @brief The most samples of envelope worked out ahead of the oscillators and filters.
+     */
+    static constexpr int ENVELOPE_BLOCK = 64;
+
+    struct OscillatorLanes
+    {
+        alignas(32) Lanes amplitude {};
+        alignas(32) Lanes modulation {};
+        alignas(32) Lanes modulationStep {};
+        alignas(32) Lanes period {};
+        alignas(32) Lanes phase {};
+        alignas(32) Lanes phaseMax {};
+        alignas(32) Lanes inc {};
+        alignas(32) Lanes dc {};
+        alignas(32) Lanes saw {};
+    };
+
+    struct EnvelopeLanes
+    {
+        alignas(32) Lanes level {};
+        alignas(32) Lanes multiplier {};
+        alignas(32) Lanes target {};
+        alignas(32) Lanes decayMultiplier {};
+        alignas(32) Lanes sustainLevel {};
+    };
+
+    // cache line aligned so that groups rendered on different threads don't share lines
+    struct alignas(64) Group
+    {
+        OscillatorLanes oscillator;
+        OscillatorLanes oscillator2;
+        FilterLanes<LANE_WIDTH> filter;
+        EnvelopeLanes env;
+        alignas(32) Lanes panLeft {};
+        alignas(32) Lanes panRight {};
+    };
+
+    std::array<Group, NUM_GROUPS> groups {};
+    std::array<bool, NUM_GROUPS> loadedGroups {};
+
+    template <typename Function>
+    void forEachLoadedGroup(Function&& function) const
+    {
+        for (int group = 0; group < NUM_GROUPS; ++group)
+        {
+            if (loadedGroups[group]) { function(group); }
+        }
+    }
+
+    /**
+     * @brief Calls a function with the lane and voice index of each voice in a group.
+     */
+    template <typename Function>
+    static void forEachVoiceInGroup(const int group, Function&& function)
+    {
+        const int begin = group * LANE_WIDTH;
+        for (int i = 0; i < std::min(LANE_WIDTH, NumVoices - begin); ++i)
+        {
+            function(i, begin + i);
+        }
+    }
+
+    static void loadOscillator(OscillatorLanes& lanes, const int i, const jx11_Oscillator& osc)
+    {
+        lanes.amplitude[i] = osc.amplitude;
+        lanes.modulation[i] = osc.modulation;
+        lanes.modulationStep[i] = osc.modulationStep;
+        lanes.period[i] = osc.period;
+        lanes.phase[i] = osc.phase;
+        lanes.phaseMax[i] = osc.phaseMax;
+        lanes.inc[i] = osc.inc;
+        lanes.dc[i] = osc.dc;
+        lanes.saw[i] = osc.saw;
+    }
+
+    static void storeOscillator(const OscillatorLanes& lanes, const int i, jx11_Oscillator& osc)
+    {
+        osc.modulation = lanes.modulation[i];
+        osc.modulationStep = lanes.modulationStep[i];
+        osc.phase = lanes.phase[i];
+        osc.phaseMax = lanes.phaseMax[i];
+        osc.inc = lanes.inc[i];
+        osc.dc = lanes.dc[i];
+        osc.saw = lanes.saw[i];
+    }
+
+    /**
+     * @brief Renders up to ENVELOPE_BLOCK samples of a group and adds its mix to the outputs.
+     *
+     * The envelopes are worked out first, all the lanes together in closed form, and
+     * then applied as a gain, so the per-sample loop has no envelope recurrence or stage
+     * changes in it. A lane is active for the samples its envelope rendered before it went
+     * silent.
+     */
+    static void renderGroupBlock(Group& g, float* left, float* right, const float* noise, const int sampleCount,
+                                 const bool noisePerVoice)
+    {
+        alignas(32) float envelope[ENVELOPE_BLOCK * LANE_WIDTH];
+        alignas(32) int activeLength[LANE_WIDTH];
+        renderEnvelopes(g.env, envelope, activeLength, sampleCount);
+
+        for (int sample = 0; sample < sampleCount; ++sample)
+        {
+            alignas(32) bool active[LANE_WIDTH];
+            alignas(32) float osc1Sample[LANE_WIDTH];
+            alignas(32) float osc2Sample[LANE_WIDTH];
+            alignas(32) float filterInput[LANE_WIDTH];
+            alignas(32) float filterOutput[LANE_WIDTH];
+            alignas(32) float voiceSample[LANE_WIDTH];
+
+            for (int i = 0; i < LANE_WIDTH; ++i)
+            {
+                active[i] = sample < activeLength[i];
+            }
+
+            renderOscillator(g.oscillator, active, osc1Sample);
+            renderOscillator(g.oscillator2, active, osc2Sample);
+
+            // filter the oscillators and noise
+            if (noisePerVoice)
+            {
+                const float* noiseFrame = noise + sample * LANE_WIDTH;
+                for (int i = 0; i < LANE_WIDTH; ++i)
+                {
+                    filterInput[i] = osc1Sample[i] + osc2Sample[i] + noiseFrame[i];
+                }
+            }
+            else
+            {
+                const float noiseSample = noise[sample];
+                for (int i = 0; i < LANE_WIDTH; ++i)
+                {
+                    filterInput[i] = osc1Sample[i] + osc2Sample[i] + noiseSample;
+                }
+            }
+            g.filter.process(filterInput, active, filterOutput);
+
+            const float* level = envelope + sample * LANE_WIDTH;
+            for (int i = 0; i < LANE_WIDTH; ++i)
+            {
+                voiceSample[i] = active[i] ? filterOutput[i] * level[i] : 0.0f;
+            }
+
+            // sum in voice order so the mix doesn't depend on the lane width
+            float outputSampleLeft = 0.0f;
+            float outputSampleRight = 0.0f;
+            for (int i = 0; i < LANE_WIDTH; ++i)
+            {
+                outputSampleLeft += voiceSample[i] * g.panLeft[i];
+                outputSampleRight += voiceSample[i] * g.panRight[i];
+            }
+            left[sample] += outputSampleLeft;
+            right[sample] += outputSampleRight;
+        }
+    }
+
+    /**
+     * @brief Renders count samples of every lane's envelope together, the lane version of
+     * ADSREnvelope::renderBlock.
+     *
+     * All the lanes are worked out in closed form, a run of ADSREnvelope::RUN_LANES samples at
+     * a time, with the same arithmetic as ADSREnvelope::renderRun. The stages only move
+     * towards their targets, so a lane can only have reached the peak of its attack or gone
+     * silent if its last level is close to it; those lanes, at most a couple of blocks a note,
+     * are rendered again with ADSREnvelope::renderBlock to split the block where the stage ends.
+     *
+     * @param env The envelope lanes, moved on by the samples rendered.
+     * @param frames The levels, LANE_WIDTH per sample, and 0 once a lane has gone silent.
+     * @param activeLength The number of samples each lane rendered before it went silent.
+     * @param count The number of samples, up to ENVELOPE_BLOCK.
+     */
+    static void renderEnvelopes(EnvelopeLanes& env, float* frames, int* activeLength, const int count)
+    {
+        constexpr int RUN_LANES = ADSREnvelope::RUN_LANES;
+
+        // silent lanes are rendered as a target and difference of 0, which stay 0
+        alignas(32) float powers[RUN_LANES][LANE_WIDTH]; // multiplier^1 to multiplier^RUN_LANES
+        alignas(32) double power[LANE_WIDTH];
+        alignas(32) double difference[LANE_WIDTH];
+        alignas(32) float target[LANE_WIDTH];
+        alignas(32) bool active[LANE_WIDTH];
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            active[i] = env.level[i] > SILENCE;
+            power[i] = 1.0;
+            difference[i] = active[i] ? double(env.level[i]) - double(env.target[i]) : 0.0;
+            target[i] = active[i] ? env.target[i] : 0.0f;
+        }
+        for (int j = 0; j < RUN_LANES; ++j)
+        {
+            for (int i = 0; i < LANE_WIDTH; ++i)
+            {
+                power[i] *= double(env.multiplier[i]);
+                powers[j][i] = float(power[i]);
+            }
+        }
+
+        for (int start = 0; start < count; start += RUN_LANES)
+        {
+            alignas(32) float runDifference[LANE_WIDTH];
+            for (int i = 0; i < LANE_WIDTH; ++i)
+            {
+                runDifference[i] = float(difference[i]);
+                difference[i] *= power[i];
+            }
+            for (int j = 0; j < std::min(RUN_LANES, count - start); ++j)
+            {
+                float* frame = frames + (start + j) * LANE_WIDTH;
+                for (int i = 0; i < LANE_WIDTH; ++i)
+                {
+                    frame[i] = target[i] + runDifference[i] * powers[j][i];
+                }
+            }
+        }
+
+        // a margin for the rounding in where ADSREnvelope decides the stage ends
+        constexpr float STAGE_END_MARGIN = 1e-3f;
+        const float* lastFrame = frames + (count - 1) * LANE_WIDTH;
+        alignas(32) bool endsStage[LANE_WIDTH];
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            const bool inAttack = env.target[i] >= 2.0f;
+            const bool peaks = inAttack && lastFrame[i] + env.target[i] > 3.0f - STAGE_END_MARGIN;
+            const bool silent = !inAttack && env.target[i] < SILENCE
+                                && lastFrame[i] <= SILENCE * (1.0f + STAGE_END_MARGIN);
+            endsStage[i] = active[i] && (peaks || silent);
+            activeLength[i] = active[i] ? count : 0;
+        }
+
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            if (endsStage[i])
+            {
+                renderEnvelopeLane(env, i, frames, activeLength, count);
+            }
+            else if (activeLength[i] > 0)
+            {
+                env.level[i] = lastFrame[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Renders count samples of one lane's envelope with ADSREnvelope::renderBlock,
+     * for a lane whose stage ends in the block.
+     */
+    static void renderEnvelopeLane(EnvelopeLanes& env, const int i, float* frames, int* activeLength, const int count)
+    {
+        ADSREnvelope lane;
+        lane.level = env.level[i];
+        lane.multiplier = env.multiplier[i];
+        lane.target = env.target[i];
+        lane.decayMultiplier = env.decayMultiplier[i];
+        lane.sustainLevel = env.sustainLevel[i];
+
+        alignas(32) float levels[ENVELOPE_BLOCK];
+        activeLength[i] = lane.renderBlock(levels, count);
+        for (int sample = 0; sample < count; ++sample)
+        {
+            frames[sample * LANE_WIDTH + i] = (sample < activeLength[i]) ? levels[sample] : 0.0f;
+        }
+
+        env.level[i] = lane.level;
+        env.multiplier[i] = lane.multiplier;
+        env.target[i] = lane.target;
+    }
+
+    /**
+     * @brief The lane version of jx11_Oscillator::render, with both BLIT branches
+     * computed and selected per lane.
+     */
+    static void renderOscillator(OscillatorLanes& o, const bool* active, float* output)
+    {
+        alignas(32) float sincPhase[LANE_WIDTH];
+
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            const float modulation = o.modulation[i] + o.modulationStep[i];
+            const float phase = o.phase[i] + o.inc[i];
+
+            // start of a new impulse
+            const float halfPeriod = (o.period[i] / 2.0f) * modulation;
+            // halfPeriod is positive, so truncating is std::floor without the library call
+            const float newPhaseMax = float(int(0.5f + halfPeriod)) - 0.5f;
+            const float newDc = 0.5f * o.amplitude[i] / newPhaseMax;
+            const float newInc = (newPhaseMax * PI) / halfPeriod;
+
+            // between impulses, reflecting back through the sinc at phaseMax
+            const bool reflect = phase > o.phaseMax[i];
+            const float reflectedPhase = FastMath::select(reflect, o.phaseMax[i] + o.phaseMax[i] - phase, phase);
+            const float reflectedInc = FastMath::select(reflect, -o.inc[i], o.inc[i]);
+
+            // selects rather than ?: so that the compiler turns the lanes into blends
+            const bool newImpulse = phase <= PI_OVER_FOUR;
+            const bool update = active[i];
+            o.modulation[i] = FastMath::select(update, modulation, o.modulation[i]);
+            sincPhase[i] = FastMath::select(newImpulse, -phase, reflectedPhase);
+            o.phase[i] = FastMath::select(update, sincPhase[i], o.phase[i]);
+            o.inc[i] = FastMath::select(update, FastMath::select(newImpulse, newInc, reflectedInc), o.inc[i]);
+            o.phaseMax[i] = FastMath::select(update && newImpulse, newPhaseMax * PI, o.phaseMax[i]);
+            o.dc[i] = FastMath::select(update && newImpulse, newDc, o.dc[i]);
+        }
+
+        // worked out in a local array, which the compiler knows isn't one of the lanes
+        alignas(32) float sample[LANE_WIDTH];
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            // the polynomial whatever JX11_SINC is, as the others don't vectorise; it's 1 at 0
+            sample[i] = o.amplitude[i] * sincPolynomial(sincPhase[i]) - o.dc[i];
+        }
+
+        for (int i = 0; i < LANE_WIDTH; ++i)
+        {
+            // keep the leaky integrator in step with jx11_Oscillator::render
+            o.saw[i] = FastMath::select(active[i], o.saw[i] * 0.997f + sample[i], o.saw[i]);
+            output[i] = sample[i];
+        }
+    }
+};
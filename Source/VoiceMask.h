@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// A fixed size set of voice indices, stored as a bitmask.
+// Used to keep track of which voices are sounding so that idle voices can be skipped.
+
+template <int NumVoices>
+class VoiceMask
+{
+public:
+    void set(const int voiceIndex) { words[wordIndex(voiceIndex)] |= bit(voiceIndex); }
+    void clear(const int voiceIndex) { words[wordIndex(voiceIndex)] &= ~bit(voiceIndex); }
+    bool test(const int voiceIndex) const { return (words[wordIndex(voiceIndex)] & bit(voiceIndex)) != 0; }
+
+    void clearAll() { words.fill(0); }
+
+    int count() const
+    {
+        int total = 0;
+        for (const auto word : words) { total += std::popcount(word); }
+        return total;
+    }
+
+    bool any() const
+    {
+        for (const auto word : words) {
+            if (word != 0) { return true; }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Finds the lowest voice index in the set.
+     * @return The voice index, or -1 if the set is empty.
+     */
+    int first() const
+    {
+        for (int i = 0; i < NUM_WORDS; ++i) {
+            if (words[i] != 0) { return i * 64 + std::countr_zero(words[i]); }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Finds the highest voice index that is not in the set.
+     * @return The voice index, or -1 if every voice is in the set.
+     */
+    int lastClear() const
+    {
+        for (int i = NUM_WORDS - 1; i >= 0; --i) {
+            uint64_t clearBits = ~words[i];
+            if (i == NUM_WORDS - 1 && NumVoices % 64 != 0) {
+                clearBits &= (uint64_t(1) << (NumVoices % 64)) - 1;
+            }
+            if (clearBits != 0) { return i * 64 + 63 - std::countl_zero(clearBits); }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Checks whether any voice in a range is in the set.
+     * @param begin The first voice index of the range.
+     * @param count The number of voices in the range, which must not cross a multiple of 64.
+     */
+    bool anyInRange(const int begin, const int count) const
+    {
+        const uint64_t rangeMask = (count >= 64) ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+        return ((words[wordIndex(begin)] >> (begin & 63)) & rangeMask) != 0;
+    }
+
+    /**
+     * @brief Calls a function with each voice index in the set, in ascending order.
+     *
+     * The function may clear the voice it is given from the set.
+     */
+    template <typename Function>
+    void forEach(Function&& function) const
+    {
+        for (int i = 0; i < NUM_WORDS; ++i) {
+            uint64_t word = words[i];
+            while (word != 0) {
+                function(i * 64 + std::countr_zero(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    static constexpr int NUM_WORDS = (NumVoices + 63) / 64;
+
+    static int wordIndex(const int voiceIndex) { return voiceIndex >> 6; }
+    static uint64_t bit(const int voiceIndex) { return uint64_t(1) << (voiceIndex & 63); }
+
+    std::array<uint64_t, NUM_WORDS> words {};
+};
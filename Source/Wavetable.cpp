@@ -0,0 +1,85 @@
+#include "Wavetable.h"
+#include <array>
+
+namespace
+{
+    constexpr double WAVETABLE_PI = 3.14159265358979323846;
+
+    std::vector<float> sawHarmonics()
+    {
+        std::vector<float> harmonics(Wavetable::TABLE_SIZE / 2);
+        for (size_t i = 0; i < harmonics.size(); ++i) {
+            const double k = double(i + 1);
+            harmonics[i] = float(-2.0 / (WAVETABLE_PI * k));
+        }
+        return harmonics;
+    }
+
+    std::vector<float> squareHarmonics()
+    {
+        std::vector<float> harmonics(Wavetable::TABLE_SIZE / 2, 0.0f);
+        for (size_t i = 0; i < harmonics.size(); i += 2) {
+            const double k = double(i + 1);
+            harmonics[i] = float(4.0 / (WAVETABLE_PI * k));
+        }
+        return harmonics;
+    }
+
+    std::vector<float> triangleHarmonics()
+    {
+        std::vector<float> harmonics(Wavetable::TABLE_SIZE / 2, 0.0f);
+        for (size_t i = 0; i < harmonics.size(); i += 2) {
+            const double k = double(i + 1);
+            const double sign = (i % 4 == 0) ? 1.0 : -1.0;
+            harmonics[i] = float(sign * 8.0 / (WAVETABLE_PI * WAVETABLE_PI * k * k));
+        }
+        return harmonics;
+    }
+}
+
+Wavetable::Wavetable(const std::vector<float>& harmonicAmplitudes)
+    : levels(size_t(NUM_LEVELS) * (TABLE_SIZE + 1))
+{
+    // sin(2 pi k n / N) is entry (k * n) mod N of a one cycle sine table
+    std::vector<double> sine(TABLE_SIZE);
+    for (int n = 0; n < TABLE_SIZE; ++n) {
+        sine[size_t(n)] = std::sin(2.0 * WAVETABLE_PI * n / TABLE_SIZE);
+    }
+
+    for (int level = 0; level < NUM_LEVELS; ++level) {
+        float* table = levels.data() + size_t(level) * (TABLE_SIZE + 1);
+        const int numHarmonics = std::min(maxHarmonic(level), int(harmonicAmplitudes.size()));
+        for (int n = 0; n < TABLE_SIZE; ++n) {
+            double sum = 0.0;
+            for (int k = 1; k <= numHarmonics; ++k) {
+                sum += harmonicAmplitudes[size_t(k - 1)] * sine[size_t((k * n) & (TABLE_SIZE - 1))];
+            }
+            table[n] = float(sum);
+        }
+        table[TABLE_SIZE] = table[0];
+    }
+}
+
+const Wavetable& Wavetable::saw()
+{
+    static const Wavetable table(sawHarmonics());
+    return table;
+}
+
+const Wavetable& Wavetable::square()
+{
+    static const Wavetable table(squareHarmonics());
+    return table;
+}
+
+const Wavetable& Wavetable::triangle()
+{
+    static const Wavetable table(triangleHarmonics());
+    return table;
+}
+
+namespace
+{
+    // Build the tables while the program is loaded, so the audio thread never has to
+    [[maybe_unused]] const bool builtInTablesBuilt = (Wavetable::saw(), Wavetable::square(), Wavetable::triangle(), true);
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file Wavetable.h
+* @author CS Islay
+* @brief A single cycle waveform, stored band-limited at one level per octave.
+*
+* Level 0 holds harmonics up to TABLE_SIZE / 2 and each level after it holds
+* half as many, so a note can always read from a level with nothing above
+* Nyquist. Tables never change once built. The built-in saw, square and
+* triangle are built when the program (or plugin) is loaded and shared by
+* every oscillator in the process.
+*****************************************************************************/
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class Wavetable
+{
+public:
+    static constexpr int TABLE_BITS = 11;
+    static constexpr int TABLE_SIZE = 1 << TABLE_BITS; ///< Samples per cycle
+    static constexpr int NUM_LEVELS = TABLE_BITS; ///< The last level is a sine
+
+    /**
+     * @brief Builds the levels by adding up sine harmonics. Not real-time safe.
+     * @param harmonicAmplitudes The amplitude of each harmonic, starting with the fundamental.
+     */
+    explicit Wavetable(const std::vector<float>& harmonicAmplitudes);
+
+    /**
+     * @brief A saw rising from -1 to 1, like the PolyBLEP saw.
+     */
+    static const Wavetable& saw();
+
+    /**
+     * @brief A square at 1 for the first half of the cycle and -1 for the second.
+     */
+    static const Wavetable& square();
+
+    /**
+     * @brief A triangle starting at 0 and rising to 1 a quarter of the way through the cycle.
+     */
+    static const Wavetable& triangle();
+
+    /**
+     * @brief The highest harmonic in a level.
+     */
+    static constexpr int maxHarmonic(const int level) { return (TABLE_SIZE / 2) >> level; }
+
+    /**
+     * @brief Chooses the level with the most harmonics that all stay below Nyquist.
+     * @param period The period of the note in samples.
+     */
+    static int levelForPeriod(const float period)
+    {
+        // level l is safe for periods of at least 2^(TABLE_BITS - l) samples
+        const int octave = std::ilogb(std::max(period, 1.0f));
+        return std::clamp(TABLE_BITS - octave, 0, NUM_LEVELS - 1);
+    }
+
+    /**
+     * @brief The samples of a level, with the first sample repeated at the end for interpolation.
+     */
+    const float* getLevel(const int level) const { return levels.data() + size_t(level) * (TABLE_SIZE + 1); }
+
+private:
+    std::vector<float> levels;
+};
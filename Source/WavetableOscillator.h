@@ -0,0 +1,91 @@
+/*****************************************************************************
+*   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
+*  d8"'    `"8b   88        88  88  88           88      d8"     "8b
+* d8'        `8b  88        88  88  88           88      Y8,
+* 88          88  88        88  88  88           88      `Y8aaaaa,
+* 88          88  88        88  88  88           88        `"""""8b,
+* Y8,    "88,,8P  88        88  88  88           88              `8b
+*  Y8a.    Y88P   Y8a.    .a8P  88  88           88      Y8a     a8P
+*   `"Y8888Y"Y8a   `"Y8888Y"'   88  88888888888  88       "Y88888P"
+*
+*    _____   __ __   __
+*   |_  \ \ / //  | /  |
+*     | |\ V / `| | `| |
+*     | |/   \  | |  | |
+* /\__/ / /^\ \_| |__| |_
+* \____/\/   \/\___/\___/
+*
+* @file WavetableOscillator.h
+* @author CS Islay
+* @brief An oscillator that plays a band-limited Wavetable.
+*
+* The level of the table is chosen from the period so that nothing aliases,
+* and each sample is a table read and a linear interpolation. The oscillator
+* only points at the table, so any number of voices can share one.
+*****************************************************************************/
+
+#pragma once
+#include "Oscillator.h"
+#include "Wavetable.h"
+
+class WavetableOscillator : public Oscillator
+{
+public:
+    const Wavetable* wavetable = &Wavetable::saw();
+    float amplitude = 1.0f;
+    float modulation = 1.0f;
+    float period = 100.0f; ///< In samples, as for jx11_Oscillator
+
+    void reset() override
+    {
+        phase = 0.0f;
+    }
+
+    float nextSample() override
+    {
+        const float currentPeriod = period * modulation;
+        const float* table = wavetable->getLevel(Wavetable::levelForPeriod(currentPeriod));
+        phase += 1.0f / currentPeriod;
+        phase -= float(int(phase));
+        return amplitude * lookup(table, phase);
+    }
+
+    /**
+     * @brief Renders a block of samples, with the level chosen once for the block.
+     *
+     * Each sample's phase is worked out from the phase at the start of the block, so
+     * the samples don't depend on each other. Matches nextSample() to within float
+     * rounding of the phase.
+     *
+     * @param output The buffer to write the samples to.
+     * @param sampleCount The number of samples to render.
+     */
+    void renderBlock(float* output, const int sampleCount)
+    {
+        const float currentPeriod = period * modulation;
+        const float* table = wavetable->getLevel(Wavetable::levelForPeriod(currentPeriod));
+        const float inc = 1.0f / currentPeriod;
+        const float startPhase = phase;
+        const float gain = amplitude;
+
+        for (int i = 0; i < sampleCount; ++i) {
+            float t = startPhase + float(i + 1) * inc;
+            t -= float(int(t));
+            output[i] = gain * lookup(table, t);
+        }
+
+        phase = startPhase + float(sampleCount) * inc;
+        phase -= float(int(phase));
+    }
+
+private:
+    float phase = 0.0f; ///< From 0 to 1 over one cycle
+
+    static float lookup(const float* table, const float t)
+    {
+        const float position = t * float(Wavetable::TABLE_SIZE);
+        const int index = int(position);
+        const float fraction = position - float(index);
+        return table[index] + fraction * (table[index + 1] - table[index]);
+    }
+};
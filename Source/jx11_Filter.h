@@ -1,6 +1,8 @@
 #pragma once
+#include <array>
 #include <cmath>
 #include "Constants.h"
+#include "FastMath.h"
 #include <iostream>
 /************************************************************************
   ,ad8888ba,    88        88  88  88      888888888888  ad88888ba
@@ -29,22 +31,85 @@ Y8,    "88,,8P  88        88  88  88           88              `8b
 class jx11_Filter
 {
 public:
+    /**
+     * @brief The filter coefficients for a cutoff, Q and sample rate.
+     */
+    struct Coefficients
+    {
+        float g = 0.0f;
+        float k = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+        float a3 = 0.0f;
+
+        // what the coefficients were calculated for
+        float cutoff = -1.0f;
+        float Q = 0.0f;
+        float sampleRate = 0.0f;
+    };
+
     void setSampleRate (const float _sampleRate) { sampleRate = _sampleRate; }
     [[nodiscard]] float getSampleRate() const { return sampleRate; }
 
     /**
      * @brief Updates the filter coefficients based on the cutoff frequency and quality factor.
      *
+     * Does nothing if the cutoff, Q and sample rate are the same as last time.
+     *
      * @param cutoff The cutoff frequency of the filter.
      * @param Q The quality factor of the filter.
      */
     void updateCoefficients(float cutoff, float Q)
     {
-        g = std::tan (PI * cutoff / sampleRate);
-        k = 1.0f / Q;
-        a1 = 1.0f / (1.0f + g * (g + k));
-        a2 = g * a1;
-        a3 = g * a2;
+        if (cutoff == coefficientCutoff && Q == coefficientQ && sampleRate == coefficientSampleRate) { return; }
+        setCoefficients(calculateCoefficients(cutoff, Q, sampleRate));
+    }
+
+    /**
+     * @brief Sets coefficients calculated elsewhere, e.g. shared with other voices.
+     */
+    void setCoefficients(const Coefficients& coefficients)
+    {
+        g = coefficients.g;
+        k = coefficients.k;
+        a1 = coefficients.a1;
+        a2 = coefficients.a2;
+        a3 = coefficients.a3;
+        coefficientCutoff = coefficients.cutoff;
+        coefficientQ = coefficients.Q;
+        coefficientSampleRate = coefficients.sampleRate;
+    }
+
+    /**
+     * @brief Calculates the coefficients for a cutoff frequency and quality factor.
+     *
+     * @param cutoff The cutoff frequency of the filter, below 0.49 times the sample rate.
+     * @param Q The quality factor of the filter.
+     * @param sampleRate The sample rate of the filter.
+     */
+    static Coefficients calculateCoefficients(const float cutoff, const float Q, const float sampleRate)
+    {
+        Coefficients coefficients;
+        coefficients.g = fastTan(PI * cutoff / sampleRate);
+        coefficients.k = 1.0f / Q;
+        coefficients.a1 = 1.0f / (1.0f + coefficients.g * (coefficients.g + coefficients.k));
+        coefficients.a2 = coefficients.g * coefficients.a1;
+        coefficients.a3 = coefficients.g * coefficients.a2;
+        coefficients.cutoff = cutoff;
+        coefficients.Q = Q;
+        coefficients.sampleRate = sampleRate;
+        return coefficients;
+    }
+
+    /**
+     * @brief tan(x) for x in [0, 0.49 pi], from FastMath's [7/6] Pade approximant.
+     *
+     * With float rounding the cutoff it gives is within 3e-7 of the one asked for,
+     * for one divide instead of a call to std::tan.
+     */
+    static float fastTan(const float x)
+    {
+        return FastMath::tan(x);
     }
 
     /**
@@ -57,6 +122,7 @@ public:
         a1 = 0.0f;
         a2 = 0.0f;
         a3 = 0.0f;
+        coefficientCutoff = -1.0f;
 
         ic1eq = 0.0f;
         ic2eq = 0.0f;
@@ -70,7 +136,7 @@ public:
      */
     float render(float x)
     {
-        float v3 = x - ic1eq;
+        float v3 = x - ic2eq;
         float v1 = a1 * ic1eq + a2 * v3;
         float v2 = ic2eq + a2 * ic1eq + a3 * v3;
         ic1eq = 2.0f * v1 - ic1eq;
@@ -78,7 +144,26 @@ public:
         return v2;
     }
 
+    /**
+     * @brief Filters a block of samples in place, equivalent to calling render() for each sample.
+     *
+     * @param buffer The samples to filter.
+     * @param sampleCount The number of samples in the buffer.
+     */
+    void renderBlock(float* buffer, const int sampleCount)
+    {
+        jx11_Filter filter = *this;
+        for (int i = 0; i < sampleCount; ++i)
+        {
+            buffer[i] = filter.render(buffer[i]);
+        }
+        *this = filter;
+    }
+
 private:
+    template <int NumVoices> friend class VoiceBank;
+    template <int Width> friend class FilterLanes;
+
     float sampleRate = 44100.0f; ///< The sample rate of the filter
 
     float g = 0.0f; ///< The normalized angular frequency coefficient.
@@ -89,6 +174,44 @@ private:
     float a2 = 0.0f; ///< Coefficient a2 used in the filter difference equations.
     float a3 = 0.0f; ///< Coefficient a3 used in the filter difference equations.
 
+    // what the coefficients were calculated for, so updateCoefficients can skip unchanged ones
+    float coefficientCutoff = -1.0f;
+    float coefficientQ = 0.0f;
+    float coefficientSampleRate = 0.0f;
+
     float ic1eq = 0.0f; ///< Internal state variable for the first integrator.
     float ic2eq = 0.0f; ///< Internal state variable for the second integrator.
-};
\ No newline at end of file
+};
+
+/**
+ * @brief A few recently used sets of filter coefficients, so that voices with the
+ * same cutoff and Q share one calculation instead of doing their own.
+ */
+class FilterCoefficientCache
+{
+public:
+    static constexpr int SIZE = 8;
+
+    /**
+     * @brief Finds the coefficients for a cutoff, Q and sample rate, calculating them if they aren't cached.
+     */
+    const jx11_Filter::Coefficients& get(const float cutoff, const float Q, const float sampleRate)
+    {
+        for (const auto& entry : entries)
+        {
+            if (entry.cutoff == cutoff && entry.Q == Q && entry.sampleRate == sampleRate) { return entry; }
+        }
+
+        // replace the oldest entry
+        auto& entry = entries[size_t(nextEntry)];
+        nextEntry = (nextEntry + 1) % SIZE;
+        entry = jx11_Filter::calculateCoefficients(cutoff, Q, sampleRate);
+        return entry;
+    }
+
+    void clear() { entries = {}; }
+
+private:
+    std::array<jx11_Filter::Coefficients, SIZE> entries {};
+    int nextEntry = 0;
+};
@@ -29,6 +29,7 @@
 #pragma once
 #include <cmath>
 #include "Oscillator.h"
+#include "Sinc.h"
 
 /**
 * @class jx11_Oscillator
@@ -41,6 +42,7 @@ class jx11_Oscillator : public Oscillator
     public:
         float amplitude = 1.0f;
         float modulation = 1.0f;
+        float modulationStep = 0.0f; ///< Added to the modulation every sample, to ramp it between control updates
         float period = 0.0f;
         float sampleRate = 44100.f;
         
@@ -50,6 +52,7 @@ class jx11_Oscillator : public Oscillator
             inc = 0.0f;
             dc = 0.0f;
             saw = 0.0f;
+            modulationStep = 0.0f;
         }
 
         /**
@@ -62,6 +65,7 @@ class jx11_Oscillator : public Oscillator
         float nextSample() override
         {
             float output = 0.0f;
+            modulation += modulationStep;
             phase += inc;
             // if phase goes over Pi/4, start a new impulse
             if (phase <= PI_OVER_FOUR) {
@@ -74,7 +78,7 @@ class jx11_Oscillator : public Oscillator
                 phase = -phase;
                 // Calculate the sinc function output (avoid dividing by zero)
                 if (phase*phase > 1e-9) {
-                    output = amplitude*sin(phase) / phase;
+                    output = scaledSinc(amplitude, phase);
                 } else {
                     output = amplitude;
                 }
@@ -86,7 +90,7 @@ class jx11_Oscillator : public Oscillator
                     inc = -inc;
                 }
                 // calculate the sinc function output - don't need to worry about divide by 0 here
-                output = amplitude * sin(phase) / phase;
+                output = scaledSinc(amplitude, phase);
             }
             return output - dc;
         };
@@ -99,6 +103,23 @@ class jx11_Oscillator : public Oscillator
             return sample;
         };
 
+        /**
+         * @brief Renders a block of samples, equivalent to calling render() for each sample.
+         *
+         * The oscillator is copied to a local so its state can stay in registers for the whole loop.
+         *
+         * @param output The buffer to write the samples to.
+         * @param sampleCount The number of samples to render.
+         */
+        void renderBlock(float* output, const int sampleCount)
+        {
+            jx11_Oscillator osc = *this;
+            for (int i = 0; i < sampleCount; ++i) {
+                output[i] = osc.render();
+            }
+            *this = osc;
+        }
+
     float getNextSquareSample()
     {
         // Similar to unipolarBlitSample, but applies a - sign to the output if it's between inpulses
@@ -117,7 +138,7 @@ class jx11_Oscillator : public Oscillator
             phase = -phase;
             // Calculate the sinc function output (avoid dividing by zero)
             if (phase*phase > 1e-9) {
-                output = amplitude*sin(phase) / phase;
+                output = scaledSinc(amplitude, phase);
             } else {
                 output = amplitude;
             }
@@ -129,13 +150,15 @@ class jx11_Oscillator : public Oscillator
                 inc = -inc;
             }
             // calculate the sinc function output - don't need to worry about divide by 0 here
-            output = amplitude * sin(phase) / phase;
+            output = scaledSinc(amplitude, phase);
         }
 
         return correctionFactor * output - dc;
     }
 
     private:
+        template <int NumVoices> friend class VoiceBank;
+
         float phase = 0;
         float phaseMax = 0;
         float inc = 0;
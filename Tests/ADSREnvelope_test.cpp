@@ -1,6 +1,7 @@
 #pragma once
 #include <gtest/gtest.h>
 #include "ADSREnvelope.h"
+#include <vector>
 
 float sampleRate = 44100.0f;
 float inverseSampleRate = 1/sampleRate;
@@ -131,3 +132,106 @@ TEST(ADSR_tests,testFullEnvelope_test)
         EXPECT_LT(nextValue, 1.0f);
     }
 }
+
+namespace
+{
+    ADSREnvelope setupEnvelope(const float attack, const float decay, const float sustain, const float release)
+    {
+        ADSREnvelope env;
+        env.reset();
+        env.setSampleRate(sampleRate);
+        env.setAttack(attack);
+        env.setDecay(decay);
+        env.setSustain(sustain);
+        env.setRelease(release);
+        return env;
+    }
+
+    // renders the same envelope per sample and per block, in blocks of blockSize
+    void expectBlockMatchesNextValue(ADSREnvelope perSample, ADSREnvelope perBlock, const int sampleCount, const int blockSize)
+    {
+        std::vector<float> block(static_cast<size_t>(blockSize));
+        int rendered = 0;
+        while (rendered < sampleCount) {
+            const int count = perBlock.renderBlock(block.data(), blockSize);
+            for (int i = 0; i < count; i++) {
+                ASSERT_TRUE(perSample.isActive()) << "sample " << rendered + i;
+                const float expected = perSample.nextValue();
+                // nextValue() picks up a rounding error every sample, the closed form doesn't
+                EXPECT_NEAR(block[size_t(i)], expected, 1e-4f * expected + 3e-7f) << "sample " << rendered + i;
+            }
+            rendered += blockSize;
+            if (count < blockSize) { break; }
+        }
+        EXPECT_EQ(perBlock.isActive(), perSample.isActive());
+    }
+}
+
+TEST(ADSR_tests,renderBlockMatchesNextValue_test)
+{
+    for (const int blockSize : { 1, 7, 64, 512 }) {
+        // attack into decay
+        ADSREnvelope env = setupEnvelope(10.0f, 50.0f, 50.0f, 30.0f);
+        env.attack();
+        expectBlockMatchesNextValue(env, env, 44100, blockSize);
+
+        // release to silence
+        ADSREnvelope released = setupEnvelope(10.0f, 50.0f, 50.0f, 30.0f);
+        released.attack();
+        for (int i = 0; i < 20000; i++) { released.nextValue(); }
+        released.release();
+        expectBlockMatchesNextValue(released, released, 10 * 44100, blockSize);
+
+        // the extra fast release
+        ADSREnvelope fast = setupEnvelope(0.0f, 0.0f, 100.0f, 0.0f);
+        fast.attack();
+        for (int i = 0; i < 1000; i++) { fast.nextValue(); }
+        fast.release();
+        expectBlockMatchesNextValue(fast, fast, 1000, blockSize);
+    }
+}
+
+TEST(ADSR_tests,renderBlockStopsWhenSilent_test)
+{
+    // with no sustain, the decay runs down to silence
+    ADSREnvelope perSample = setupEnvelope(0.0f, 20.0f, 0.0f, 20.0f);
+    perSample.attack();
+    ADSREnvelope perBlock = perSample;
+
+    int samplesPerSample = 0;
+    while (perSample.isActive()) {
+        perSample.nextValue();
+        samplesPerSample++;
+    }
+
+    std::vector<float> block(static_cast<size_t>(samplesPerSample + 100));
+    const int samplesPerBlock = perBlock.renderBlock(block.data(), int(block.size()));
+    EXPECT_NEAR(samplesPerBlock, samplesPerSample, 1);
+    EXPECT_FALSE(perBlock.isActive());
+    EXPECT_LE(block[size_t(samplesPerBlock - 1)], SILENCE);
+}
+TEST(ADSR_tests,renderBlockHoldsAnInstantSustain_test)
+{
+    // a decay that jumps straight to its sustain level holds it, it doesn't go silent
+    ADSREnvelope perSample;
+    perSample.reset();
+    perSample.attackMultiplier = 0.99f;
+    perSample.decayMultiplier = 0.0f;
+    perSample.sustainLevel = 0.5f;
+    perSample.attack();
+    expectBlockMatchesNextValue(perSample, perSample, 4096, 64);
+
+    ADSREnvelope perBlock = perSample;
+    std::vector<float> block(4096);
+    EXPECT_EQ(perBlock.renderBlock(block.data(), 4096), 4096);
+    EXPECT_FLOAT_EQ(block.back(), 0.5f);
+    EXPECT_TRUE(perBlock.isActive());
+
+    // and so does a freshly reset envelope, which jumps to a sustain of 1
+    ADSREnvelope fresh;
+    fresh.reset();
+    fresh.attack();
+    expectBlockMatchesNextValue(fresh, fresh, 4096, 64);
+    EXPECT_EQ(fresh.renderBlock(block.data(), 4096), 4096);
+    EXPECT_FLOAT_EQ(block.back(), 1.0f);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "ControlRamp.h"
+#include <vector>
+
+TEST(ControlRampTests, firstTargetJumps_test)
+{
+    ControlRamp ramp;
+    ramp.reset();
+    ramp.setTarget(0.5f, 100);
+    EXPECT_FALSE(ramp.isRamping());
+    EXPECT_EQ(0.5f, ramp.getValue());
+}
+
+TEST(ControlRampTests, rampsLinearlyToTarget_test)
+{
+    ControlRamp ramp;
+    ramp.setValue(0.0f);
+    ramp.setTarget(1.0f, 10);
+
+    std::vector<float> buffer(static_cast<size_t>(16), 1.0f);
+    ramp.applyGain(buffer.data(), int(buffer.size()));
+    for (size_t i = 0; i < 10; i++) {
+        EXPECT_NEAR(float(i + 1) / 10.0f, buffer[i], 1e-6f);
+    }
+    for (size_t i = 10; i < buffer.size(); i++) {
+        EXPECT_EQ(1.0f, buffer[i]);
+    }
+
+    // applying the gain doesn't move the ramp
+    EXPECT_EQ(0.0f, ramp.getValue());
+    ramp.advance(int(buffer.size()));
+    EXPECT_FALSE(ramp.isRamping());
+    EXPECT_EQ(1.0f, ramp.getValue());
+}
+
+TEST(ControlRampTests, chunksMatchOneBlock_test)
+{
+    ControlRamp whole;
+    whole.setValue(0.25f);
+    whole.setTarget(0.75f, 37);
+    ControlRamp chunked = whole;
+
+    std::vector<float> expected(static_cast<size_t>(64), 1.0f);
+    whole.applyGain(expected.data(), int(expected.size()));
+
+    std::vector<float> actual(static_cast<size_t>(64), 1.0f);
+    for (int start = 0; start < int(actual.size()); start += 16) {
+        chunked.applyGain(actual.data() + start, 16);
+        chunked.advance(16);
+    }
+    for (size_t i = 0; i < actual.size(); i++) {
+        EXPECT_NEAR(expected[i], actual[i], 1e-6f);
+    }
+    EXPECT_EQ(0.75f, chunked.getValue());
+}
+
+TEST(ControlRampTests, interleavedFramesMatchOneChannel_test)
+{
+    ControlRamp ramp;
+    ramp.setValue(0.25f);
+    ramp.setTarget(0.75f, 20);
+
+    std::vector<float> expected(static_cast<size_t>(32), 1.0f);
+    ramp.applyGain(expected.data(), int(expected.size()));
+
+    // every channel of a frame gets the same gain
+    constexpr int channels = 3;
+    std::vector<float> frames(expected.size() * channels, 1.0f);
+    ramp.applyGain(frames.data(), int(expected.size()), channels);
+    for (size_t i = 0; i < frames.size(); i++) {
+        EXPECT_EQ(expected[i / channels], frames[i]) << i;
+    }
+}
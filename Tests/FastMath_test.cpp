@@ -0,0 +1,115 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "FastMath.h"
+#include <cmath>
+#include <vector>
+
+using FastMath::Precision;
+
+namespace
+{
+    // The largest absolute and relative errors of a function over [from, to], against a double reference
+    template <typename Reference>
+    std::pair<double, double> maxErrors(float (*function)(float), Reference&& reference, const float from, const float to,
+                                        const int steps = 200000)
+    {
+        double absolute = 0.0, relative = 0.0;
+        for (int i = 0; i <= steps; ++i) {
+            const float x = from + (to - from) * float(i) / float(steps);
+            const double expected = reference(double(x));
+            const double error = std::abs(double(function(x)) - expected);
+            absolute = std::max(absolute, error);
+            if (expected != 0.0) { relative = std::max(relative, error / std::abs(expected)); }
+        }
+        return { absolute, relative };
+    }
+}
+
+TEST(FastMathTests, sin_test)
+{
+    const auto sine = [] (const double x) { return std::sin(x); };
+    EXPECT_LT(maxErrors(FastMath::sin<Precision::High>, sine, -10.0f, 10.0f).first, 3.5e-7);
+    EXPECT_LT(maxErrors(FastMath::sin<Precision::Low>, sine, -10.0f, 10.0f).first, 1.1e-4);
+    // the reduction keeps its accuracy up to about 25000
+    EXPECT_LT(maxErrors(FastMath::sin<Precision::High>, sine, 20000.0f, 25000.0f).first, 3.5e-7);
+    EXPECT_EQ(0.0f, FastMath::sin(0.0f));
+}
+
+TEST(FastMathTests, cos_test)
+{
+    const auto cosine = [] (const double x) { return std::cos(x); };
+    EXPECT_LT(maxErrors(FastMath::cos<Precision::High>, cosine, -10.0f, 10.0f).first, 3.5e-7);
+    EXPECT_LT(maxErrors(FastMath::cos<Precision::Low>, cosine, -10.0f, 10.0f).first, 1.1e-4);
+    EXPECT_LT(maxErrors(FastMath::cos<Precision::High>, cosine, -25000.0f, -20000.0f).first, 3.5e-7);
+}
+
+TEST(FastMathTests, exp_test)
+{
+    const auto exponential = [] (const double x) { return std::exp(x); };
+    EXPECT_LT(maxErrors(FastMath::exp<Precision::High>, exponential, -87.0f, 88.0f).second, 1.5e-7);
+    EXPECT_LT(maxErrors(FastMath::exp<Precision::Low>, exponential, -87.0f, 88.0f).second, 7.5e-5);
+    EXPECT_EQ(1.0f, FastMath::exp(0.0f));
+
+    // saturates rather than going to zero or infinity
+    EXPECT_GT(FastMath::exp(-1000.0f), 0.0f);
+    EXPECT_TRUE(std::isnormal(FastMath::exp(-1000.0f)));
+    EXPECT_TRUE(std::isfinite(FastMath::exp(1000.0f)));
+}
+
+TEST(FastMathTests, exp2_test)
+{
+    const auto power = [] (const double x) { return std::exp2(x); };
+    EXPECT_LT(maxErrors(FastMath::exp2<Precision::High>, power, -126.0f, 127.0f).second, 1.5e-7);
+    EXPECT_LT(maxErrors(FastMath::exp2<Precision::Low>, power, -126.0f, 127.0f).second, 7.5e-5);
+    for (int k = -126; k <= 127; ++k) {
+        EXPECT_EQ(std::ldexp(1.0f, k), FastMath::exp2(float(k))) << k;
+    }
+    EXPECT_EQ(std::ldexp(1.0f, -126), FastMath::exp2(-200.0f));
+    EXPECT_EQ(std::ldexp(1.0f, 127), FastMath::exp2(200.0f));
+}
+
+TEST(FastMathTests, tan_test)
+{
+    constexpr float LIMIT = 0.49f * 3.14159265f;
+    const auto tangent = [] (const double x) { return std::tan(x); };
+    EXPECT_LT(maxErrors(FastMath::tan<Precision::High>, tangent, -LIMIT, LIMIT).second, 3e-6);
+    EXPECT_LT(maxErrors(FastMath::tan<Precision::Low>, tangent, -LIMIT, LIMIT).second, 3e-4);
+}
+
+TEST(FastMathTests, tanh_test)
+{
+    const auto hyperbolic = [] (const double x) { return std::tanh(x); };
+    EXPECT_LT(maxErrors(FastMath::tanh<Precision::High>, hyperbolic, -20.0f, 20.0f).first, 1.5e-7);
+    EXPECT_LT(maxErrors(FastMath::tanh<Precision::Low>, hyperbolic, -20.0f, 20.0f).first, 1e-4);
+    // it never overshoots, so it can be used as a limiter
+    for (const float x : { 5.0f, 50.0f, 1.0e30f }) {
+        EXPECT_LE(FastMath::tanh<Precision::Low>(x), 1.0f);
+        EXPECT_LE(FastMath::tanh<Precision::High>(x), 1.0f);
+        EXPECT_GE(FastMath::tanh<Precision::Low>(-x), -1.0f);
+        EXPECT_GE(FastMath::tanh<Precision::High>(-x), -1.0f);
+    }
+}
+
+TEST(FastMathTests, blockMatchesScalar_test)
+{
+    // every length from the vectorised runs to the scalar tail, and in place
+    for (const int count : { 0, 1, 7, 8, 9, 64, 67 }) {
+        std::vector<float> input(static_cast<size_t>(count)), output(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) { input[size_t(i)] = -3.0f + 0.1f * float(i); }
+
+        FastMath::sin(input.data(), output.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::sin(input[size_t(i)]), output[size_t(i)]) << i; }
+        FastMath::cos<Precision::Low>(input.data(), output.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::cos<Precision::Low>(input[size_t(i)]), output[size_t(i)]) << i; }
+        FastMath::exp(input.data(), output.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::exp(input[size_t(i)]), output[size_t(i)]) << i; }
+        FastMath::exp2<Precision::Low>(input.data(), output.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::exp2<Precision::Low>(input[size_t(i)]), output[size_t(i)]) << i; }
+        FastMath::tanh(input.data(), output.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::tanh(input[size_t(i)]), output[size_t(i)]) << i; }
+
+        auto inPlace = input;
+        FastMath::tan(inPlace.data(), inPlace.data(), count);
+        for (int i = 0; i < count; ++i) { EXPECT_EQ(FastMath::tan(input[size_t(i)]), inPlace[size_t(i)]) << i; }
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "FilterLanes.h"
+#include <cmath>
+
+namespace
+{
+    constexpr int WIDTH = 8;
+
+    // a different cutoff and Q in every lane
+    jx11_Filter::Coefficients laneCoefficients(const int lane)
+    {
+        return jx11_Filter::calculateCoefficients(200.0f * float(lane + 1), 0.5f + 0.5f * float(lane), 48000.0f);
+    }
+
+    float testInput(const int sample, const int lane)
+    {
+        return std::sin(0.01f * float(sample * (lane + 1))) + ((sample % 50 < 25) ? 0.25f : -0.25f);
+    }
+}
+
+TEST(FilterLanesTests, matchesScalarFilter_test)
+{
+    FilterLanes<WIDTH> lanes;
+    std::array<jx11_Filter, WIDTH> filters;
+    for (int lane = 0; lane < WIDTH; lane++) {
+        filters[size_t(lane)].reset();
+        filters[size_t(lane)].setCoefficients(laneCoefficients(lane));
+        lanes.load(lane, filters[size_t(lane)]);
+    }
+
+    bool active[WIDTH];
+    std::fill(std::begin(active), std::end(active), true);
+    for (int sample = 0; sample < 2000; sample++) {
+        float input[WIDTH];
+        float lowpass[WIDTH];
+        for (int lane = 0; lane < WIDTH; lane++) { input[lane] = testInput(sample, lane); }
+        lanes.process(input, active, lowpass);
+        for (int lane = 0; lane < WIDTH; lane++) {
+            EXPECT_FLOAT_EQ(lowpass[lane], filters[size_t(lane)].render(input[lane]));
+        }
+    }
+}
+
+TEST(FilterLanesTests, inactiveLanesKeepTheirState_test)
+{
+    FilterLanes<WIDTH> lanes;
+    jx11_Filter filter;
+    filter.reset();
+    filter.setCoefficients(laneCoefficients(0));
+    for (int lane = 0; lane < WIDTH; lane++) { lanes.setCoefficients(lane, laneCoefficients(0)); }
+
+    // every other lane runs
+    bool active[WIDTH];
+    for (int lane = 0; lane < WIDTH; lane++) { active[lane] = lane % 2 == 0; }
+    for (int sample = 0; sample < 100; sample++) {
+        float input[WIDTH];
+        float lowpass[WIDTH];
+        std::fill(std::begin(input), std::end(input), testInput(sample, 0));
+        lanes.process(input, active, lowpass);
+        filter.render(input[0]);
+    }
+
+    // the running lanes carry on from where the filter is, the others from silence
+    jx11_Filter silent;
+    silent.reset();
+    silent.setCoefficients(laneCoefficients(0));
+    for (int lane = 0; lane < WIDTH; lane++) {
+        jx11_Filter stored = silent;
+        lanes.store(lane, stored);
+        jx11_Filter expected = active[lane] ? filter : silent;
+        EXPECT_FLOAT_EQ(stored.render(1.0f), expected.render(1.0f)) << "lane " << lane;
+    }
+}
+
+TEST(FilterLanesTests, outputsAddUpToInput_test)
+{
+    // for the SVF, highpass + k * bandpass + lowpass gives back the input
+    FilterLanes<WIDTH> lanes;
+    for (int lane = 0; lane < WIDTH; lane++) { lanes.setCoefficients(lane, laneCoefficients(lane)); }
+
+    bool active[WIDTH];
+    std::fill(std::begin(active), std::end(active), true);
+    FilterLanes<WIDTH>::Outputs outputs;
+    for (int sample = 0; sample < 2000; sample++) {
+        float input[WIDTH];
+        for (int lane = 0; lane < WIDTH; lane++) { input[lane] = testInput(sample, lane); }
+        lanes.process(input, active, outputs);
+        for (int lane = 0; lane < WIDTH; lane++) {
+            const float k = laneCoefficients(lane).k;
+            const float sum = outputs.highpass[size_t(lane)] + k * outputs.bandpass[size_t(lane)] + outputs.lowpass[size_t(lane)];
+            EXPECT_NEAR(sum, input[lane], 1e-5f);
+        }
+    }
+}
+
+TEST(FilterLanesTests, responses_test)
+{
+    // a constant input ends up all in the lowpass, none in the bandpass or highpass
+    FilterLanes<WIDTH> lanes;
+    for (int lane = 0; lane < WIDTH; lane++) { lanes.setCoefficients(lane, laneCoefficients(lane)); }
+
+    bool active[WIDTH];
+    std::fill(std::begin(active), std::end(active), true);
+    float input[WIDTH];
+    std::fill(std::begin(input), std::end(input), 1.0f);
+    FilterLanes<WIDTH>::Outputs outputs;
+    for (int sample = 0; sample < 48000; sample++) { lanes.process(input, active, outputs); }
+
+    for (int lane = 0; lane < WIDTH; lane++) {
+        EXPECT_NEAR(outputs.lowpass[size_t(lane)], 1.0f, 1e-4f);
+        EXPECT_NEAR(outputs.bandpass[size_t(lane)], 0.0f, 1e-4f);
+        EXPECT_NEAR(outputs.highpass[size_t(lane)], 0.0f, 1e-4f);
+    }
+}
+
+TEST(FilterLanesTests, renderBlock_test)
+{
+    FilterLanes<4> lanes;
+    std::array<jx11_Filter, 4> filters;
+    for (int lane = 0; lane < 4; lane++) {
+        filters[size_t(lane)].reset();
+        filters[size_t(lane)].setCoefficients(laneCoefficients(lane));
+        lanes.setCoefficients(lane, laneCoefficients(lane));
+    }
+
+    constexpr int frames = 256;
+    std::array<float, frames * 4> buffer;
+    for (int frame = 0; frame < frames; frame++) {
+        for (int lane = 0; lane < 4; lane++) { buffer[size_t(frame * 4 + lane)] = testInput(frame, lane); }
+    }
+    lanes.renderBlock(buffer.data(), frames);
+
+    for (int frame = 0; frame < frames; frame++) {
+        for (int lane = 0; lane < 4; lane++) {
+            EXPECT_FLOAT_EQ(buffer[size_t(frame * 4 + lane)], filters[size_t(lane)].render(testInput(frame, lane)));
+        }
+    }
+}
@@ -43,4 +43,80 @@ TEST(FilterTests, Filter_test)
         EXPECT_LT(nextValue, 1.0f);
         EXPECT_NE (oscSample, nextValue);
     }
-}
\ No newline at end of file
+}
+
+TEST(FilterTests, FastTan_test)
+{
+    // tan is so steep near the top that it's the cutoff the filter ends up with that matters,
+    // up to 0.49 times the sample rate
+    for (int i = 1; i <= 1000; i++) {
+        const float x = 0.49f * PI * float(i) / 1000.0f;
+        const double cutoff = std::atan(double(jx11_Filter::fastTan(x)));
+        EXPECT_NEAR(cutoff, x, 3e-7 * x);
+    }
+    EXPECT_NEAR(jx11_Filter::fastTan(0.1f), std::tan(0.1), 1e-8);
+}
+
+TEST(FilterTests, UnchangedCoefficients_test)
+{
+    jx11_Filter filter;
+    filter.reset();
+    filter.setSampleRate(44100.0f);
+    filter.updateCoefficients(1000.0f, 0.707f);
+
+    // recalculating the same coefficients mustn't change the output
+    jx11_Filter recalculated = filter;
+    for (int i = 0; i < 1000; i++) {
+        recalculated.updateCoefficients(1000.0f, 0.707f);
+        EXPECT_EQ(filter.render(0.5f), recalculated.render(0.5f));
+    }
+
+    // but a new cutoff must
+    recalculated.updateCoefficients(2000.0f, 0.707f);
+    EXPECT_NE(filter.render(-0.5f), recalculated.render(-0.5f));
+}
+
+TEST(FilterTests, CoefficientCache_test)
+{
+    FilterCoefficientCache cache;
+    const auto& first = cache.get(1000.0f, 0.707f, 44100.0f);
+    const auto& second = cache.get(1000.0f, 0.707f, 44100.0f);
+    EXPECT_EQ(&first, &second);
+    EXPECT_NE(&first, &cache.get(1000.0f, 0.707f, 48000.0f));
+
+    // shared coefficients filter the same as calculating them in the filter
+    jx11_Filter own;
+    own.reset();
+    own.setSampleRate(44100.0f);
+    own.updateCoefficients(1000.0f, 0.707f);
+    jx11_Filter shared;
+    shared.reset();
+    shared.setSampleRate(44100.0f);
+    shared.setCoefficients(cache.get(1000.0f, 0.707f, 44100.0f));
+    for (int i = 0; i < 1000; i++) {
+        const float input = (i % 100 < 50) ? 0.5f : -0.5f;
+        EXPECT_EQ(own.render(input), shared.render(input));
+    }
+
+    // more settings than entries still gives the right coefficients
+    for (int i = 0; i < 3 * FilterCoefficientCache::SIZE; i++) {
+        const float cutoff = 100.0f * float(i + 1);
+        const auto& coefficients = cache.get(cutoff, 0.707f, 44100.0f);
+        EXPECT_EQ(coefficients.cutoff, cutoff);
+        EXPECT_EQ(coefficients.g, jx11_Filter::calculateCoefficients(cutoff, 0.707f, 44100.0f).g);
+    }
+}
+
+TEST(FilterTests, DCPassesThrough_test)
+{
+    // a lowpass filter passes a constant input unchanged once it settles
+    jx11_Filter filter;
+    filter.reset();
+    filter.setSampleRate(44100.0f);
+    filter.updateCoefficients(1000.0f, 0.707f);
+    float output = 0.0f;
+    for (int i = 0; i < 44100; i++) {
+        output = filter.render(1.0f);
+    }
+    EXPECT_NEAR(output, 1.0f, 1e-4f);
+}
@@ -0,0 +1,213 @@
+//
+// Renders canned MIDI scenarios through Synth and compares them with reference renders kept in
+// Tests/Golden, so DSP optimisations can be shown to leave the output alone.
+//
+// Each reference is the stereo output, interleaved little-endian 32-bit floats, of one scenario at
+// one sample rate: Tests/Golden/<scenario>_<rate>.f32. Golden_test.cpp checks every build against
+// them to within each scenario's SNR threshold, both sample by sample and for the short-time magnitude spectra,
+// which don't mind the slow phase drift a change in rounding leaves; and to the bit when the
+// JX11_GOLDEN_EXACT CMake option is on.
+//
+// Run the tests with JX11_UPDATE_GOLDEN=1 in the environment to write the references again, but
+// only in a commit that is meant to alter the sound, and that says so. An optimisation has to pass
+// against the references it started from, or it hasn't been checked at all.
+//
+
+#ifndef GOLDEN_RENDER_H
+#define GOLDEN_RENDER_H
+
+#include "SynthParameters.h"
+#include "Synth.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numbers>
+#include <string>
+#include <vector>
+
+static_assert(std::endian::native == std::endian::little, "the references are stored little-endian");
+
+struct GoldenEvent
+{
+    double time; // seconds from the start
+    uint8_t data0, data1, data2;
+};
+
+struct GoldenScenario
+{
+    std::string name;
+    SynthParameters patch;
+    std::vector<GoldenEvent> events;
+    double minSnrDb; // how close a build has to be, sample by sample and in its spectra, when it isn't bit-exact
+};
+
+inline constexpr double GOLDEN_DURATION = 0.2; // seconds rendered per scenario
+inline constexpr int GOLDEN_BLOCK_SIZE = 128;
+inline constexpr int GOLDEN_MAX_VOICES = 8; // the polyphony the references were rendered with
+inline constexpr double GOLDEN_SAMPLE_RATES[] = { 44100.0, 48000.0, 96000.0 };
+inline constexpr size_t GOLDEN_FRAME_SIZE = 1024; // samples per spectrum, about 20 ms at 48 kHz
+
+// Renders a scenario the way the plugin would: in blocks, split at the MIDI events
+inline std::vector<float> renderGoldenScenario(const GoldenScenario& scenario, const double sampleRate)
+{
+    Synth synth;
+    synth.setOversampling(1);
+    synth.allocateResources(sampleRate, GOLDEN_BLOCK_SIZE);
+    synth.reset();
+    scenario.patch.applyTo(synth, float(sampleRate));
+
+    const int totalSamples = int(GOLDEN_DURATION * sampleRate);
+    std::vector<float> left(static_cast<size_t>(totalSamples)), right(static_cast<size_t>(totalSamples));
+    size_t nextEvent = 0;
+
+    for (int blockStart = 0; blockStart < totalSamples; blockStart += GOLDEN_BLOCK_SIZE) {
+        const int blockEnd = std::min(blockStart + GOLDEN_BLOCK_SIZE, totalSamples);
+        int offset = blockStart;
+        while (nextEvent < scenario.events.size()) {
+            const auto& event = scenario.events[nextEvent];
+            const int eventSample = std::max(int(std::lround(event.time * sampleRate)), offset);
+            if (eventSample >= blockEnd) { break; }
+            if (eventSample > offset) {
+                float* outputBuffers[2] = { left.data() + offset, right.data() + offset };
+                synth.render(outputBuffers, eventSample - offset);
+                offset = eventSample;
+            }
+            synth.midiMessages(event.data0, event.data1, event.data2);
+            nextEvent++;
+        }
+        if (blockEnd > offset) {
+            float* outputBuffers[2] = { left.data() + offset, right.data() + offset };
+            synth.render(outputBuffers, blockEnd - offset);
+        }
+    }
+    synth.deallocateResources();
+
+    std::vector<float> interleaved(size_t(2 * totalSamples));
+    for (size_t i = 0; i < size_t(totalSamples); i++) {
+        interleaved[2 * i] = left[i];
+        interleaved[2 * i + 1] = right[i];
+    }
+    return interleaved;
+}
+
+struct GoldenComparison
+{
+    bool sameLength = false;
+    bool bitExact = false;
+    double snrDb = 0.0; // infinite when the renders match
+    double spectralSnrDb = 0.0; // the same for the short-time magnitude spectra, which ignores phase
+    double maxError = 0.0;
+    long firstDifference = -1; // the first interleaved sample that isn't bit-exact
+};
+
+// An in-place radix-2 FFT, for a power of two number of points
+inline void goldenFft(std::vector<std::complex<double>>& points)
+{
+    const size_t n = points.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; (j & bit) != 0; bit >>= 1) { j ^= bit; }
+        j ^= bit;
+        if (i < j) { std::swap(points[i], points[j]); }
+    }
+    for (size_t length = 2; length <= n; length <<= 1) {
+        const double angle = -2.0 * std::numbers::pi / double(length);
+        for (size_t start = 0; start < n; start += length) {
+            for (size_t k = 0; k < length / 2; k++) {
+                const auto twiddle = std::polar(1.0, angle * double(k));
+                const auto even = points[start + k];
+                const auto odd = points[start + k + length / 2] * twiddle;
+                points[start + k] = even + odd;
+                points[start + k + length / 2] = even - odd;
+            }
+        }
+    }
+}
+
+// The magnitude spectra of one channel of an interleaved stereo render, in Hann windowed frames
+// of GOLDEN_FRAME_SIZE that overlap by half, one after the other
+inline std::vector<double> goldenSpectra(const std::vector<float>& interleaved, const size_t channel)
+{
+    const size_t length = interleaved.size() / 2;
+    std::vector<double> magnitudes;
+    std::vector<std::complex<double>> points(GOLDEN_FRAME_SIZE);
+    for (size_t start = 0; start < length; start += GOLDEN_FRAME_SIZE / 2) {
+        for (size_t i = 0; i < GOLDEN_FRAME_SIZE; i++) {
+            const double window = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * double(i) / double(GOLDEN_FRAME_SIZE));
+            const size_t sample = start + i;
+            points[i] = (sample < length) ? window * double(interleaved[2 * sample + channel]) : 0.0;
+        }
+        goldenFft(points);
+        for (size_t bin = 0; bin <= GOLDEN_FRAME_SIZE / 2; bin++) { magnitudes.push_back(std::abs(points[bin])); }
+    }
+    return magnitudes;
+}
+
+// 10 log10(signal / error) as a comparison reports it: infinite for no error, and minus infinity
+// rather than NaN when something isn't finite
+inline double goldenSnrDb(const double signal, const double error)
+{
+    const double snrDb = (error == 0.0) ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(signal / error);
+    return std::isnan(snrDb) ? -std::numeric_limits<double>::infinity() : snrDb;
+}
+
+inline GoldenComparison compareToGolden(const std::vector<float>& rendered, const std::vector<float>& reference)
+{
+    GoldenComparison comparison;
+    comparison.sameLength = rendered.size() == reference.size();
+    if (!comparison.sameLength) { return comparison; }
+
+    double signal = 0.0, error = 0.0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        const double difference = double(rendered[i]) - double(reference[i]);
+        signal += double(reference[i]) * double(reference[i]);
+        error += difference * difference;
+        comparison.maxError = std::max(comparison.maxError, std::abs(difference));
+        // compares the bits, so a NaN that has crept in doesn't count as a match
+        if (comparison.firstDifference < 0 && std::memcmp(&rendered[i], &reference[i], sizeof(float)) != 0) {
+            comparison.firstDifference = long(i);
+        }
+    }
+    comparison.bitExact = comparison.firstDifference < 0;
+    comparison.snrDb = goldenSnrDb(signal, error);
+
+    double spectralSignal = 0.0, spectralError = 0.0;
+    for (const size_t channel : { size_t(0), size_t(1) }) {
+        const auto renderedSpectra = goldenSpectra(rendered, channel);
+        const auto referenceSpectra = goldenSpectra(reference, channel);
+        for (size_t i = 0; i < referenceSpectra.size(); i++) {
+            const double difference = renderedSpectra[i] - referenceSpectra[i];
+            spectralSignal += referenceSpectra[i] * referenceSpectra[i];
+            spectralError += difference * difference;
+        }
+    }
+    comparison.spectralSnrDb = goldenSnrDb(spectralSignal, spectralError);
+    return comparison;
+}
+
+inline std::string goldenPath(const std::string& directory, const GoldenScenario& scenario, const double sampleRate)
+{
+    return directory + "/" + scenario.name + "_" + std::to_string(int(sampleRate)) + ".f32";
+}
+
+inline bool readGolden(const std::string& path, std::vector<float>& samples)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) { return false; }
+    samples.resize(size_t(file.tellg()) / sizeof(float));
+    file.seekg(0);
+    return bool(file.read(reinterpret_cast<char*>(samples.data()), std::streamsize(samples.size() * sizeof(float))));
+}
+
+inline bool writeGolden(const std::string& path, const std::vector<float>& samples)
+{
+    std::ofstream file(path, std::ios::binary);
+    return bool(file.write(reinterpret_cast<const char*>(samples.data()), std::streamsize(samples.size() * sizeof(float))));
+}
+
+#endif //GOLDEN_RENDER_H
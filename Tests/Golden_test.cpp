@@ -0,0 +1,231 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "GoldenRender.h"
+#include <cstdlib>
+#include <numbers>
+
+#ifndef JX11_GOLDEN_DIR
+    #define JX11_GOLDEN_DIR "Golden"
+#endif
+
+#ifndef JX11_GOLDEN_EXACT
+    #define JX11_GOLDEN_EXACT 0
+#endif
+
+namespace
+{
+    constexpr uint8_t NOTE_ON = 0x90;
+    constexpr uint8_t NOTE_OFF = 0x80;
+    constexpr uint8_t CONTROL_CHANGE = 0xB0;
+    constexpr uint8_t PITCH_BEND = 0xE0;
+    constexpr uint8_t SUSTAIN_PEDAL = 0x40;
+
+    GoldenScenario chords()
+    {
+        GoldenScenario scenario { "chords", {}, {}, 100.0 };
+        scenario.patch.oscMix = 40.0f;
+        scenario.patch.oscFine = 7.0f;
+        scenario.patch.filterEnv = 60.0f;
+        scenario.events = {
+            { 0.0, NOTE_ON, 60, 100 }, { 0.0, NOTE_ON, 64, 100 }, { 0.0, NOTE_ON, 67, 100 },
+            { 0.08, NOTE_OFF, 60, 0 }, { 0.08, NOTE_OFF, 64, 0 }, { 0.08, NOTE_OFF, 67, 0 },
+            { 0.09, NOTE_ON, 65, 80 }, { 0.09, NOTE_ON, 69, 80 }, { 0.09, NOTE_ON, 72, 80 },
+            { 0.16, NOTE_OFF, 65, 0 }, { 0.16, NOTE_OFF, 69, 0 }, { 0.16, NOTE_OFF, 72, 0 },
+        };
+        return scenario;
+    }
+
+    // a note every 10 ms, held for 8 ms, so the releases overlap and voices get stolen
+    GoldenScenario arpeggio()
+    {
+        GoldenScenario scenario { "arpeggio", {}, {}, 90.0 };
+        scenario.patch.envDecay = 20.0f;
+        scenario.patch.envSustain = 30.0f;
+        scenario.patch.envRelease = 60.0f;
+        scenario.patch.filterVelocity = 50.0f;
+        const uint8_t pattern[] = { 48, 55, 60, 64, 67, 72, 76, 79, 84, 79, 76, 72, 67, 64, 60, 55, 48, 60, 72, 84 };
+        for (int i = 0; i < 20; i++) {
+            const double time = 0.01 * i;
+            scenario.events.push_back({ time, NOTE_ON, pattern[i], uint8_t(40 + 4 * i) });
+            scenario.events.push_back({ time + 0.008, NOTE_OFF, pattern[i], 0 });
+        }
+        return scenario;
+    }
+
+    GoldenScenario sustainPedal()
+    {
+        GoldenScenario scenario { "sustainPedal", {}, {}, 100.0 };
+        scenario.patch.envRelease = 40.0f;
+        scenario.events = {
+            { 0.0, NOTE_ON, 48, 90 }, { 0.0, NOTE_ON, 55, 90 },
+            { 0.02, CONTROL_CHANGE, SUSTAIN_PEDAL, 127 },
+            { 0.05, NOTE_OFF, 48, 0 }, { 0.05, NOTE_OFF, 55, 0 },
+            { 0.07, NOTE_ON, 60, 70 }, { 0.09, NOTE_OFF, 60, 0 },
+            { 0.11, NOTE_ON, 48, 110 }, // the same note again while it's sustained
+            { 0.14, CONTROL_CHANGE, SUSTAIN_PEDAL, 0 },
+            { 0.17, NOTE_OFF, 48, 0 },
+        };
+        return scenario;
+    }
+
+    // one note with vibrato, bent up to the top, down to the bottom and back, every 2.5 ms
+    GoldenScenario pitchBend()
+    {
+        GoldenScenario scenario { "pitchBend", {}, {}, 100.0 };
+        scenario.patch.polyMode = 0.0f;
+        scenario.patch.vibrato = 30.0f;
+        scenario.patch.lfoRate = 0.9f;
+        scenario.events.push_back({ 0.0, NOTE_ON, 57, 100 });
+        for (int step = 1; step < 72; step++) {
+            const double position = double(step) / 72.0; // 0 to 1 over the sweep
+            const double bend = (position < 0.25) ? position * 4.0
+                              : (position < 0.75) ? 1.0 - (position - 0.25) * 4.0
+                              : -1.0 + (position - 0.75) * 4.0;
+            const int value = std::clamp(8192 + int(std::lround(bend * 8191.0)), 0, 16383);
+            scenario.events.push_back({ 0.0025 * step, PITCH_BEND, uint8_t(value & 0x7F), uint8_t(value >> 7) });
+        }
+        scenario.events.push_back({ 0.185, NOTE_OFF, 57, 0 });
+        return scenario;
+    }
+
+    GoldenScenario noiseMix()
+    {
+        GoldenScenario scenario { "noiseMix", {}, {}, 100.0 };
+        scenario.patch.noise = 60.0f;
+        scenario.patch.filterReso = 60.0f;
+        scenario.patch.filterLFO = 40.0f;
+        scenario.events = {
+            { 0.0, NOTE_ON, 45, 100 }, { 0.03, NOTE_ON, 52, 60 },
+            { 0.12, NOTE_OFF, 45, 0 }, { 0.15, NOTE_OFF, 52, 0 },
+        };
+        return scenario;
+    }
+
+    // Each scenario's threshold holds for both SNRs. Measured against the references, from the
+    // worst scenario and rate:
+    //                                                  SNR      spectral SNR
+    //   the sinc approximations                        134 dB   135 dB
+    //   FMA contraction (-march=native)                102 dB   106 dB (the arpeggio)
+    // pass; changes to the arithmetic, which have to record new references in their own commit:
+    //   closed-form envelopes rather than recurrence    78 dB    78 dB
+    //   FastMath::sin for the vibrato LFO               75 dB    76 dB
+    //   a pitch bend table that rounds twice            82 dB   102 dB
+    // and changes to the patch:
+    //   the output level 0.01 dB up                     59 dB    59 dB
+    //   envRelease or oscMix 1% up                      49 dB    52 dB
+    //   tuning a cent up                                18 dB    38 dB
+    //   a sample late                                   18 dB    54 dB
+    // fail. The arpeggio steals voices, which leaves its rounding more room to grow.
+
+    // Renders a scenario at every rate and checks it against the references, or writes them
+    void checkGolden(const GoldenScenario& scenario)
+    {
+        // which voice plays a note sets its analog drift, so other polyphonies sound different
+        if (Synth::MAX_VOICES != GOLDEN_MAX_VOICES) {
+            GTEST_SKIP() << "the references are for " << GOLDEN_MAX_VOICES << " voices";
+        }
+        const bool update = std::getenv("JX11_UPDATE_GOLDEN") != nullptr;
+
+        for (const double sampleRate : GOLDEN_SAMPLE_RATES) {
+            SCOPED_TRACE(testing::Message() << scenario.name << " at " << sampleRate << " Hz");
+            const std::string path = goldenPath(JX11_GOLDEN_DIR, scenario, sampleRate);
+            const auto rendered = renderGoldenScenario(scenario, sampleRate);
+
+            if (update) {
+                EXPECT_TRUE(writeGolden(path, rendered)) << "couldn't write " << path;
+                continue;
+            }
+
+            std::vector<float> reference;
+            ASSERT_TRUE(readGolden(path, reference))
+                << "no reference at " << path << ", run the tests with JX11_UPDATE_GOLDEN=1 to make one";
+            const auto comparison = compareToGolden(rendered, reference);
+            ASSERT_TRUE(comparison.sameLength) << rendered.size() << " samples rendered, " << reference.size() << " in " << path;
+            EXPECT_GE(comparison.snrDb, scenario.minSnrDb) << "largest error " << comparison.maxError;
+            EXPECT_GE(comparison.spectralSnrDb, scenario.minSnrDb);
+            if (JX11_GOLDEN_EXACT) {
+                EXPECT_TRUE(comparison.bitExact) << "first differs at interleaved sample " << comparison.firstDifference
+                                                 << ", SNR " << comparison.snrDb << " dB";
+            }
+        }
+    }
+}
+
+TEST(GoldenTests, compareToGolden_test)
+{
+    const std::vector<float> reference { 0.5f, -0.5f, 0.25f, -0.25f };
+
+    auto comparison = compareToGolden(reference, reference);
+    EXPECT_TRUE(comparison.bitExact);
+    EXPECT_TRUE(std::isinf(comparison.snrDb) && comparison.snrDb > 0.0);
+
+    // an error 1000 times smaller than the signal is 60 dB down
+    auto changed = reference;
+    for (auto& sample : changed) { sample *= 1.001f; }
+    comparison = compareToGolden(changed, reference);
+    EXPECT_FALSE(comparison.bitExact);
+    EXPECT_EQ(0, comparison.firstDifference);
+    EXPECT_NEAR(60.0, comparison.snrDb, 0.01);
+
+    changed = reference;
+    changed[3] = std::numeric_limits<float>::quiet_NaN();
+    comparison = compareToGolden(changed, reference);
+    EXPECT_EQ(3, comparison.firstDifference);
+    EXPECT_FALSE(comparison.snrDb > 0.0);
+
+    EXPECT_FALSE(compareToGolden({ 0.5f }, reference).sameLength);
+}
+
+TEST(GoldenTests, spectralSnrIgnoresPhase_test)
+{
+    // a second of 1 kHz in both channels, the same a hundredth of a radian later, and 0.1% louder
+    std::vector<float> reference, later, louder;
+    for (int i = 0; i < 48000; i++) {
+        const double phase = 2.0 * std::numbers::pi * 1000.0 * i / 48000.0;
+        for (int channel = 0; channel < 2; channel++) {
+            reference.push_back(float(0.5 * std::sin(phase)));
+            later.push_back(float(0.5 * std::sin(phase - 0.01)));
+            louder.push_back(float(0.5005 * std::sin(phase)));
+        }
+    }
+
+    auto comparison = compareToGolden(later, reference);
+    EXPECT_NEAR(40.0, comparison.snrDb, 0.1);
+    EXPECT_GT(comparison.spectralSnrDb, 80.0);
+
+    comparison = compareToGolden(louder, reference);
+    EXPECT_NEAR(60.0, comparison.snrDb, 0.1);
+    EXPECT_NEAR(60.0, comparison.spectralSnrDb, 0.1);
+}
+
+// The thresholds have to catch small changes to the sound, so these are rendered against the
+// unchanged patch rather than the references, and run whatever the polyphony
+TEST(GoldenTests, patchChangesFail_test)
+{
+    const GoldenScenario scenario = chords();
+    const auto expected = renderGoldenScenario(scenario, 48000.0);
+
+    GoldenScenario changed = scenario;
+    changed.patch.outputLevel += 0.01f;
+    auto comparison = compareToGolden(renderGoldenScenario(changed, 48000.0), expected);
+    EXPECT_LT(comparison.snrDb, scenario.minSnrDb);
+    EXPECT_LT(comparison.spectralSnrDb, scenario.minSnrDb);
+
+    changed = scenario;
+    changed.patch.envRelease += 1.0f;
+    comparison = compareToGolden(renderGoldenScenario(changed, 48000.0), expected);
+    EXPECT_LT(comparison.snrDb, scenario.minSnrDb);
+    EXPECT_LT(comparison.spectralSnrDb, scenario.minSnrDb);
+
+    changed = scenario;
+    changed.patch.tuning += 1.0f;
+    comparison = compareToGolden(renderGoldenScenario(changed, 48000.0), expected);
+    EXPECT_LT(comparison.snrDb, scenario.minSnrDb);
+    EXPECT_LT(comparison.spectralSnrDb, scenario.minSnrDb);
+}
+
+TEST(GoldenTests, chords_test) { checkGolden(chords()); }
+TEST(GoldenTests, arpeggio_test) { checkGolden(arpeggio()); }
+TEST(GoldenTests, sustainPedal_test) { checkGolden(sustainPedal()); }
+TEST(GoldenTests, pitchBend_test) { checkGolden(pitchBend()); }
+TEST(GoldenTests, noiseMix_test) { checkGolden(noiseMix()); }
@@ -0,0 +1,111 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "HalfBandDecimator.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr double TEST_PI = 3.14159265358979323846;
+
+    // a sine at a frequency given as a fraction of the output rate, at factor times that rate
+    std::vector<float> oversampledSine(const double frequency, const int factor, const int outputCount)
+    {
+        std::vector<float> input(static_cast<size_t>(factor * outputCount));
+        for (size_t i = 0; i < input.size(); i++) {
+            input[i] = float(std::sin(2.0 * TEST_PI * frequency * double(i) / double(factor)));
+        }
+        return input;
+    }
+
+    // the amplitude of a decimated sine once the filter has settled, from its projection onto a sine
+    // and cosine over a whole number of periods (the filter delay falls between output samples)
+    float decimatedLevel(const double frequency, const int factor)
+    {
+        constexpr int outputCount = 4096;
+        constexpr int settled = 256;
+        auto input = oversampledSine(frequency, factor, outputCount);
+        std::vector<float> output(static_cast<size_t>(outputCount));
+        Decimator decimator;
+        decimator.prepare(factor, outputCount);
+        decimator.process(input.data(), output.data(), outputCount);
+
+        double sine = 0.0;
+        double cosine = 0.0;
+        for (int i = settled; i < outputCount; i++) {
+            sine += output[size_t(i)] * std::sin(2.0 * TEST_PI * frequency * double(i));
+            cosine += output[size_t(i)] * std::cos(2.0 * TEST_PI * frequency * double(i));
+        }
+        return float(2.0 * std::hypot(sine, cosine) / double(outputCount - settled));
+    }
+}
+
+TEST(HalfBandDecimatorTests, passesDC_test)
+{
+    HalfBandDecimator<Decimator::FINAL_PAIRS> decimator;
+    decimator.prepare(64);
+    std::vector<float> input(static_cast<size_t>(128), 0.5f);
+    std::vector<float> output(static_cast<size_t>(64));
+    decimator.process(input.data(), output.data(), 64);
+    EXPECT_NEAR(0.5f, output.back(), 1e-6f);
+}
+
+TEST(HalfBandDecimatorTests, passesAudioAndStopsAliases_test)
+{
+    for (const int factor : { 2, 4 }) {
+        // 1 kHz and 19 kHz at 48 kHz pass (each is a whole number of periods in 3840 samples)
+        EXPECT_NEAR(1.0f, decimatedLevel(1000.0 / 48000.0, factor), 0.001f) << factor;
+        EXPECT_NEAR(1.0f, decimatedLevel(19000.0 / 48000.0, factor), 0.001f) << factor;
+
+        // 29 kHz would alias down to 19 kHz
+        EXPECT_LT(20.0f * std::log10(decimatedLevel(29000.0 / 48000.0, factor)), -75.0f) << factor;
+    }
+    // at 4x, what's left after the first stage mustn't alias either
+    EXPECT_LT(20.0f * std::log10(decimatedLevel(77000.0 / 48000.0, 4)), -75.0f);
+}
+
+TEST(HalfBandDecimatorTests, blocksMatchOneBlock_test)
+{
+    constexpr int outputCount = 300;
+    auto input = oversampledSine(0.1, 4, outputCount);
+    auto blockInput = input;
+
+    Decimator whole;
+    whole.prepare(4, outputCount);
+    std::vector<float> expected(static_cast<size_t>(outputCount));
+    whole.process(input.data(), expected.data(), outputCount);
+
+    Decimator blocks;
+    blocks.prepare(4, 64);
+    std::vector<float> actual(static_cast<size_t>(outputCount));
+    for (int start = 0; start < outputCount; start += 64) {
+        const int count = std::min(64, outputCount - start);
+        blocks.process(blockInput.data() + 4 * start, actual.data() + start, count);
+    }
+
+    for (size_t i = 0; i < actual.size(); i++) {
+        EXPECT_EQ(expected[i], actual[i]) << i;
+    }
+}
+
+TEST(HalfBandDecimatorTests, latency_test)
+{
+    // an impulse comes out centred on the filter's delay
+    for (const int factor : { 2, 4 }) {
+        constexpr int outputCount = 64;
+        std::vector<float> input(static_cast<size_t>(factor * outputCount), 0.0f);
+        input[0] = 1.0f;
+        std::vector<float> output(static_cast<size_t>(outputCount));
+        Decimator decimator;
+        decimator.prepare(factor, outputCount);
+        decimator.process(input.data(), output.data(), outputCount);
+
+        double sum = 0.0;
+        double moment = 0.0;
+        for (int i = 0; i < outputCount; i++) {
+            sum += output[size_t(i)];
+            moment += double(i) * output[size_t(i)];
+        }
+        EXPECT_NEAR(decimator.getLatency(), moment / sum, 0.01) << factor;
+    }
+}
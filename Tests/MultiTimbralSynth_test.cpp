@@ -0,0 +1,275 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "MultiTimbralSynth.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr double MULTI_TEST_RATE = 48000.0;
+    constexpr int MULTI_TEST_BLOCK = 256;
+
+    void setupMulti(MultiTimbralSynth& multiSynth, const int renderThreads = 0)
+    {
+        multiSynth.setOversampling(1);
+        multiSynth.setRenderThreads(renderThreads);
+        multiSynth.allocateResources(MULTI_TEST_RATE, MULTI_TEST_BLOCK);
+        multiSynth.reset();
+    }
+
+    // Renders sampleCount samples into numChannels channels, in blocks of MULTI_TEST_BLOCK
+    std::vector<std::vector<float>> renderMulti(MultiTimbralSynth& multiSynth, const int numChannels,
+                                                const int sampleCount)
+    {
+        std::vector<std::vector<float>> channels(static_cast<size_t>(numChannels),
+                                                 std::vector<float>(static_cast<size_t>(sampleCount)));
+        for (int offset = 0; offset < sampleCount; offset += MULTI_TEST_BLOCK) {
+            std::vector<float*> outputs;
+            for (auto& channel : channels) { outputs.push_back(channel.data() + offset); }
+            multiSynth.render(outputs.data(), numChannels, std::min(MULTI_TEST_BLOCK, sampleCount - offset));
+        }
+        return channels;
+    }
+
+    void renderSynth(Synth& synth, std::vector<float>& left, std::vector<float>& right, const int sampleCount)
+    {
+        left.assign(size_t(sampleCount), 0.0f);
+        right.assign(size_t(sampleCount), 0.0f);
+        for (int offset = 0; offset < sampleCount; offset += MULTI_TEST_BLOCK) {
+            float* outputBuffers[2] = { left.data() + offset, right.data() + offset };
+            synth.render(outputBuffers, std::min(MULTI_TEST_BLOCK, sampleCount - offset));
+        }
+    }
+
+    float peak(const std::vector<float>& samples)
+    {
+        float result = 0.0f;
+        for (const float sample : samples) { result = std::max(result, std::abs(sample)); }
+        return result;
+    }
+
+    SynthParameters brassPatch()
+    {
+        SynthParameters parameters;
+        parameters.filterFreq = 20.0f;
+        parameters.filterReso = 60.0f;
+        parameters.envAttack = 30.0f;
+        return parameters;
+    }
+}
+
+TEST(MultiTimbralSynthTests, partMatchesSynth_test)
+{
+    const SynthParameters patch = brassPatch();
+
+    Synth synth;
+    synth.setOversampling(1);
+    synth.allocateResources(MULTI_TEST_RATE, MULTI_TEST_BLOCK);
+    synth.reset();
+    patch.applyTo(synth, float(MULTI_TEST_RATE));
+    synth.midiMessages(0x90, 48, 100);
+    synth.midiMessages(0x90, 55, 90);
+    std::vector<float> left, right;
+    renderSynth(synth, left, right, 9000);
+
+    // the same notes on channel 4, with nothing else playing
+    MultiTimbralSynth multiSynth;
+    multiSynth.setPartEnabled(0, false);
+    multiSynth.setPartEnabled(3, true);
+    multiSynth.setPartParameters(3, patch);
+    setupMulti(multiSynth);
+    multiSynth.midiMessages(0x93, 48, 100);
+    multiSynth.midiMessages(0x93, 55, 90);
+    const auto channels = renderMulti(multiSynth, 2, 9000);
+
+    EXPECT_GT(peak(left), 0.01f);
+    EXPECT_EQ(left, channels[0]);
+    EXPECT_EQ(right, channels[1]);
+}
+
+TEST(MultiTimbralSynthTests, channelsGoToTheirOwnParts_test)
+{
+    MultiTimbralSynth multiSynth;
+    multiSynth.setPartEnabled(1, true);
+    setupMulti(multiSynth);
+
+    multiSynth.midiMessages(0x90, 60, 100);
+    multiSynth.midiMessages(0x91, 64, 100);
+    multiSynth.midiMessages(0x91, 67, 100);
+    multiSynth.midiMessages(0x92, 72, 100); // part off, ignored
+    EXPECT_EQ(1, multiSynth.getPart(0).getActiveVoiceCount());
+    EXPECT_EQ(2, multiSynth.getPart(1).getActiveVoiceCount());
+    EXPECT_EQ(0, multiSynth.getPart(2).getActiveVoiceCount());
+    EXPECT_EQ(3, multiSynth.getActiveVoiceCount());
+
+    // a note off on one channel leaves the same note on another alone
+    multiSynth.midiMessages(0x91, 60, 100);
+    multiSynth.midiMessages(0x81, 60, 0);
+    renderMulti(multiSynth, 2, 48000);
+    EXPECT_EQ(1, multiSynth.getPart(0).getActiveVoiceCount());
+}
+
+TEST(MultiTimbralSynthTests, partsHaveTheirOwnPatches_test)
+{
+    MultiTimbralSynth multiSynth;
+    multiSynth.setPartEnabled(1, true);
+    multiSynth.setPartBus(1, 1);
+    multiSynth.setPartParameters(1, brassPatch());
+    setupMulti(multiSynth);
+
+    multiSynth.midiMessages(0x90, 57, 100);
+    multiSynth.midiMessages(0x91, 57, 100);
+    const auto channels = renderMulti(multiSynth, 4, 9000);
+    EXPECT_GT(peak(channels[0]), 0.01f);
+    EXPECT_GT(peak(channels[2]), 0.01f);
+    EXPECT_NE(channels[0], channels[2]);
+
+    // changing a patch while playing changes only that part
+    SynthParameters brighter = brassPatch();
+    brighter.filterFreq = 80.0f;
+    multiSynth.setPartParameters(1, brighter);
+    EXPECT_EQ(brighter.differences(multiSynth.getPartParameters(1)), 0u);
+    EXPECT_EQ(SynthParameters {}.differences(multiSynth.getPartParameters(0)), 0u);
+}
+
+TEST(MultiTimbralSynthTests, busesAndMonoMix_test)
+{
+    auto play = [](MultiTimbralSynth& multiSynth) {
+        multiSynth.midiMessages(0x90, 48, 100);
+        multiSynth.midiMessages(0x91, 67, 100);
+    };
+
+    MultiTimbralSynth stereo;
+    stereo.setPartEnabled(1, true);
+    setupMulti(stereo);
+    play(stereo);
+    const auto mixed = renderMulti(stereo, 2, 4000);
+
+    MultiTimbralSynth split;
+    split.setPartEnabled(1, true);
+    split.setPartBus(1, 1);
+    setupMulti(split);
+    play(split);
+    const auto buses = renderMulti(split, 4, 4000);
+
+    // each part alone on its bus, and the two added up when they share one
+    for (size_t i = 0; i < 4000; ++i) {
+        EXPECT_EQ(mixed[0][i], buses[0][i] + buses[2][i]) << i;
+        EXPECT_EQ(mixed[1][i], buses[1][i] + buses[3][i]) << i;
+    }
+
+    // a bus the output doesn't have falls back to the first
+    MultiTimbralSynth missingBus;
+    missingBus.setPartEnabled(1, true);
+    missingBus.setPartBus(1, 5);
+    setupMulti(missingBus);
+    play(missingBus);
+    EXPECT_EQ(mixed, renderMulti(missingBus, 2, 4000));
+
+    MultiTimbralSynth mono;
+    mono.setPartEnabled(1, true);
+    setupMulti(mono);
+    play(mono);
+    const auto monoChannel = renderMulti(mono, 1, 4000);
+    // each part is folded down before they are added, so only to rounding
+    for (size_t i = 0; i < 4000; ++i) {
+        EXPECT_NEAR(monoChannel[0][i], (mixed[0][i] + mixed[1][i]) * 0.5f, 1e-6f) << i;
+    }
+}
+
+TEST(MultiTimbralSynthTests, parallelMatchesSerial_test)
+{
+    std::vector<std::vector<float>> reference;
+    for (const int renderThreads : { 0, 1, 3, 8 }) {
+        MultiTimbralSynth multiSynth;
+        for (int channel = 0; channel < 6; ++channel) {
+            SynthParameters parameters;
+            parameters.filterFreq = 20.0f + 10.0f * float(channel);
+            multiSynth.setPartEnabled(channel, true);
+            multiSynth.setPartBus(channel, channel % 2);
+            multiSynth.setPartParameters(channel, parameters);
+        }
+        setupMulti(multiSynth, renderThreads);
+        for (int channel = 0; channel < 6; ++channel) {
+            multiSynth.midiMessages(uint8_t(0x90 | channel), uint8_t(40 + 5 * channel), 100);
+            multiSynth.midiMessages(uint8_t(0x90 | channel), uint8_t(47 + 5 * channel), 80);
+        }
+        const auto channels = renderMulti(multiSynth, 4, 6000);
+        multiSynth.deallocateResources();
+
+        if (reference.empty()) {
+            reference = channels;
+            EXPECT_GT(peak(reference[0]), 0.01f);
+            EXPECT_GT(peak(reference[2]), 0.01f);
+        } else {
+            EXPECT_EQ(reference, channels) << renderThreads;
+        }
+    }
+}
+
+TEST(MultiTimbralSynthTests, switchingAPartLeavesTheOthersPlaying_test)
+{
+    MultiTimbralSynth steady, switched;
+    for (MultiTimbralSynth* multiSynth : { &steady, &switched }) {
+        multiSynth->setPartBus(1, 1);
+        setupMulti(*multiSynth, 2);
+        multiSynth->midiMessages(0x90, 48, 100);
+    }
+    const auto expected = renderMulti(steady, 4, 3 * MULTI_TEST_BLOCK);
+    auto rendered = renderMulti(switched, 4, MULTI_TEST_BLOCK);
+
+    // the second part comes on and plays on its own bus, and the note on the first carries on
+    // as if nothing happened, then the second goes off again
+    switched.switchPart(1, true);
+    EXPECT_TRUE(switched.isPartEnabled(1));
+    switched.midiMessages(0x91, 67, 100);
+    EXPECT_EQ(2, switched.getActiveVoiceCount());
+    const auto both = renderMulti(switched, 4, MULTI_TEST_BLOCK);
+    EXPECT_GT(peak(both[2]), 0.01f);
+    switched.switchPart(1, false);
+    EXPECT_EQ(1, switched.getActiveVoiceCount());
+    const auto after = renderMulti(switched, 4, MULTI_TEST_BLOCK);
+
+    for (size_t channel = 0; channel < 2; ++channel) {
+        rendered[channel].insert(rendered[channel].end(), both[channel].begin(), both[channel].end());
+        rendered[channel].insert(rendered[channel].end(), after[channel].begin(), after[channel].end());
+        EXPECT_EQ(expected[channel], rendered[channel]) << channel;
+    }
+}
+
+TEST(MultiTimbralSynthTests, rendersNothingWithoutBuffersOrChannels_test)
+{
+    std::vector<float> left(100, 1.0f), right(100, 1.0f);
+    float* outputs[2] = { left.data(), right.data() };
+
+    // not allocated yet
+    MultiTimbralSynth multiSynth;
+    multiSynth.midiMessages(0x90, 60, 100);
+    multiSynth.render(outputs, 2, 100);
+    EXPECT_EQ(1.0f, left[0]);
+
+    // no outputs to write to
+    setupMulti(multiSynth);
+    multiSynth.midiMessages(0x90, 60, 100);
+    multiSynth.render(nullptr, 0, 100);
+    multiSynth.render(outputs, 2, 100);
+    EXPECT_NE(1.0f, left[0]);
+}
+
+TEST(MultiTimbralSynthTests, longBlocksAreSplit_test)
+{
+    MultiTimbralSynth blocked, whole;
+    setupMulti(blocked);
+    setupMulti(whole);
+    blocked.midiMessages(0x90, 60, 100);
+    whole.midiMessages(0x90, 60, 100);
+    const auto expected = renderMulti(blocked, 2, 1000);
+
+    // more than the block size passed to allocateResources at once
+    std::vector<float> left(1000), right(1000);
+    float* outputs[2] = { left.data(), right.data() };
+    whole.render(outputs, 2, 1000);
+    EXPECT_EQ(expected[0], left);
+    EXPECT_EQ(expected[1], right);
+}
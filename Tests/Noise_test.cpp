@@ -0,0 +1,150 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "Noise.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    double meanSquare(const std::vector<float>& samples)
+    {
+        double sum = 0.0;
+        for (const float sample : samples) { sum += double(sample) * double(sample); }
+        return sum / double(samples.size());
+    }
+
+    // The power of the first difference relative to the signal's: 2 for white noise, less the darker it is
+    double differencePower(const std::vector<float>& samples)
+    {
+        double sum = 0.0;
+        for (size_t i = 1; i < samples.size(); ++i) {
+            const double difference = double(samples[i]) - double(samples[i - 1]);
+            sum += difference * difference;
+        }
+        return sum / double(samples.size() - 1) / meanSquare(samples);
+    }
+}
+
+TEST(NoiseTests, fillMatchesNextValue_test)
+{
+    for (const NoiseColour colour : { NoiseColour::White, NoiseColour::Pink }) {
+        Noise filled, stepped;
+        filled.reset();
+        stepped.reset();
+        filled.setColour(colour);
+        stepped.setColour(colour);
+
+        // runs of eight and the samples left over, carried on from one call to the next
+        for (const int count : { 0, 1, 7, 8, 9, 64, 100 }) {
+            std::vector<float> buffer(static_cast<size_t>(count));
+            filled.fill(buffer.data(), count);
+            for (const float sample : buffer) {
+                if (colour == NoiseColour::White) {
+                    EXPECT_EQ(stepped.nextValue(), sample) << count;
+                } else {
+                    EXPECT_FLOAT_EQ(stepped.nextValue(), sample) << count;
+                }
+            }
+        }
+    }
+}
+
+TEST(NoiseTests, whiteNoiseRange_test)
+{
+    Noise noise;
+    noise.reset();
+    std::vector<float> buffer(static_cast<size_t>(100000));
+    noise.fill(buffer.data(), int(buffer.size()));
+    for (const float sample : buffer) {
+        EXPECT_GE(sample, -1.0f);
+        EXPECT_LT(sample, 1.0f);
+    }
+    // uniform from -1 to 1
+    EXPECT_NEAR(1.0 / 3.0, meanSquare(buffer), 0.01);
+    EXPECT_NEAR(2.0, differencePower(buffer), 0.05);
+}
+
+TEST(NoiseTests, pinkNoiseIsDarker_test)
+{
+    Noise noise;
+    noise.reset();
+    noise.setColour(NoiseColour::Pink);
+    std::vector<float> buffer(static_cast<size_t>(200000));
+    noise.fill(buffer.data(), int(buffer.size()));
+
+    // the same level as the white noise, with much less of it at the top
+    EXPECT_NEAR(1.0 / 3.0, meanSquare(buffer), 0.05);
+    EXPECT_LT(differencePower(buffer), 0.5);
+}
+
+TEST(NoiseTests, lanesAreIndependent_test)
+{
+    constexpr int streams = 8;
+    constexpr int frames = 20000;
+    NoiseLanes<streams> lanes;
+    lanes.reset();
+    std::vector<float> buffer(static_cast<size_t>(frames * streams));
+    lanes.fill(buffer.data(), frames);
+
+    std::vector<std::vector<float>> channels(streams);
+    for (int i = 0; i < streams; ++i) {
+        for (int frame = 0; frame < frames; ++frame) { channels[size_t(i)].push_back(buffer[size_t(frame * streams + i)]); }
+        EXPECT_NEAR(1.0 / 3.0, meanSquare(channels[size_t(i)]), 0.02) << i;
+        EXPECT_NEAR(2.0, differencePower(channels[size_t(i)]), 0.1) << i;
+    }
+
+    // neighbouring streams are uncorrelated
+    for (int i = 0; i + 1 < streams; ++i) {
+        double sum = 0.0;
+        for (int frame = 0; frame < frames; ++frame) {
+            sum += double(channels[size_t(i)][size_t(frame)]) * double(channels[size_t(i + 1)][size_t(frame)]);
+        }
+        const double correlation = sum / double(frames) / (1.0 / 3.0);
+        EXPECT_LT(std::abs(correlation), 0.03) << i;
+    }
+}
+
+TEST(NoiseTests, lanesRepeatAfterReset_test)
+{
+    NoiseLanes<8> lanes, otherGroup;
+    lanes.reset();
+    otherGroup.reset(8);
+    std::vector<float> first(static_cast<size_t>(8 * 64)), second(first.size()), other(first.size());
+
+    lanes.fill(first.data(), 64);
+    lanes.reset();
+    lanes.fill(second.data(), 64);
+    otherGroup.fill(other.data(), 64);
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+
+    // splitting a fill doesn't change the streams
+    lanes.reset();
+    lanes.fill(second.data(), 13);
+    lanes.fill(second.data() + 13 * 8, 51);
+    EXPECT_EQ(first, second);
+}
+
+TEST(NoiseTests, pinkLanesMatchOneStream_test)
+{
+    // the filter treats every stream the same as a single one
+    PinkNoiseFilter<4> lanes;
+    PinkNoiseFilter<1> single;
+    lanes.reset();
+    single.reset();
+
+    Noise noise;
+    noise.reset();
+    std::vector<float> white(static_cast<size_t>(4 * 300));
+    noise.fill(white.data(), int(white.size()));
+
+    std::vector<float> frames = white;
+    lanes.process(frames.data(), 300);
+    std::vector<float> stream(static_cast<size_t>(300));
+    for (size_t i = 0; i < stream.size(); ++i) { stream[i] = white[4 * i + 2]; }
+    single.process(stream.data(), 300);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        EXPECT_FLOAT_EQ(stream[i], frames[4 * i + 2]) << i;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "OutputSafety.h"
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // an odd length, so the samples after the last whole run are checked too
+    constexpr int BLOCK_SIZE = 37;
+
+    struct StereoBlock
+    {
+        std::vector<float> left = std::vector<float>(size_t(BLOCK_SIZE), 0.25f);
+        std::vector<float> right = std::vector<float>(size_t(BLOCK_SIZE), -0.25f);
+        float* channels[2] = { left.data(), right.data() };
+
+        bool isSilent() const
+        {
+            for (size_t i = 0; i < left.size(); i++) {
+                if (left[i] != 0.0f || right[i] != 0.0f) { return false; }
+            }
+            return true;
+        }
+    };
+}
+
+TEST(OutputSafetyTests, ordinaryAudioIsUntouched_test)
+{
+    OutputSafety safety;
+    StereoBlock block;
+    EXPECT_FALSE(safety.process(block.channels, 2, BLOCK_SIZE));
+    for (size_t i = 0; i < block.left.size(); i++) {
+        EXPECT_EQ(0.25f, block.left[i]);
+        EXPECT_EQ(-0.25f, block.right[i]);
+    }
+    EXPECT_EQ(0u, safety.counters().clampedSamples);
+    EXPECT_EQ(0u, safety.counters().mutedBlocks);
+}
+
+TEST(OutputSafetyTests, clampsSamplesPastFullScale_test)
+{
+    OutputSafety safety;
+    StereoBlock block;
+    block.left[3] = 1.5f;
+    block.right[BLOCK_SIZE - 1] = -1.25f;
+    EXPECT_FALSE(safety.process(block.channels, 2, BLOCK_SIZE));
+    EXPECT_EQ(1.0f, block.left[3]);
+    EXPECT_EQ(-1.0f, block.right[BLOCK_SIZE - 1]);
+    EXPECT_EQ(0.25f, block.left[4]);
+    EXPECT_EQ(2u, safety.counters().clampedSamples);
+    EXPECT_EQ(0u, safety.counters().mutedBlocks);
+}
+
+TEST(OutputSafetyTests, mutesBrokenBlocks_test)
+{
+    OutputSafety safety;
+
+    StereoBlock feedback;
+    feedback.left[10] = 3.0f;
+    EXPECT_TRUE(safety.process(feedback.channels, 2, BLOCK_SIZE));
+    EXPECT_TRUE(feedback.isSilent());
+
+    StereoBlock notANumber;
+    notANumber.right[BLOCK_SIZE - 1] = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_TRUE(safety.process(notANumber.channels, 2, BLOCK_SIZE));
+    EXPECT_TRUE(notANumber.isSilent());
+
+    StereoBlock infinity;
+    infinity.left[0] = -std::numeric_limits<float>::infinity();
+    EXPECT_TRUE(safety.process(infinity.channels, 2, BLOCK_SIZE));
+    EXPECT_TRUE(infinity.isSilent());
+
+    EXPECT_EQ(3u, safety.counters().mutedBlocks);
+    EXPECT_EQ(2u, safety.counters().nonFiniteBlocks);
+
+    safety.resetCounters();
+    EXPECT_EQ(0u, safety.counters().mutedBlocks);
+}
+
+TEST(OutputSafetyTests, skipsMissingChannels_test)
+{
+    OutputSafety safety;
+    std::vector<float> mono(size_t(BLOCK_SIZE), 2.5f);
+    float* channels[2] = { mono.data(), nullptr };
+    EXPECT_TRUE(safety.process(channels, 2, BLOCK_SIZE));
+    for (const float sample : mono) {
+        EXPECT_EQ(0.0f, sample);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "ParameterSnapshot.h"
+
+namespace
+{
+    // stands in for the values in the plugin's parameter tree
+    struct Sources
+    {
+        std::array<std::atomic<float>, SynthParameters::COUNT> values;
+
+        Sources()
+        {
+            const SynthParameters defaults;
+            for (size_t index = 0; index < values.size(); index++) {
+                values[index].store(defaults.*SynthParameters::entries[index].value);
+            }
+        }
+
+        void connect(ParameterSnapshot& snapshot)
+        {
+            for (int index = 0; index < SynthParameters::COUNT; index++) {
+                snapshot.setSource(index, &values[size_t(index)]);
+            }
+        }
+
+        void set(float SynthParameters::* parameter, const float value)
+        {
+            for (size_t index = 0; index < values.size(); index++) {
+                if (SynthParameters::entries[index].value == parameter) { values[index].store(value); }
+            }
+        }
+    };
+}
+
+TEST(ParameterSnapshotTests, firstUpdateChangesEverything_test)
+{
+    Sources sources;
+    ParameterSnapshot snapshot;
+    sources.connect(snapshot);
+    EXPECT_EQ(SynthParameters::ALL_CHANGED, snapshot.update());
+    EXPECT_EQ(0u, snapshot.update());
+}
+
+TEST(ParameterSnapshotTests, reportsChangedParameters_test)
+{
+    Sources sources;
+    ParameterSnapshot snapshot;
+    sources.connect(snapshot);
+    snapshot.update();
+
+    sources.set(&SynthParameters::noise, 40.0f);
+    sources.set(&SynthParameters::envAttack, 10.0f);
+    EXPECT_EQ(SynthParameters::maskOf(&SynthParameters::noise) | SynthParameters::maskOf(&SynthParameters::envAttack),
+              snapshot.update());
+    EXPECT_EQ(40.0f, snapshot.current().noise);
+    EXPECT_EQ(10.0f, snapshot.current().envAttack);
+
+    // the same values again are no change
+    EXPECT_EQ(0u, snapshot.update());
+    EXPECT_EQ(40.0f, snapshot.current().noise);
+
+    // and the snapshot doesn't lose earlier changes when it swaps buffers
+    sources.set(&SynthParameters::octave, 1.0f);
+    EXPECT_EQ(SynthParameters::maskOf(&SynthParameters::octave), snapshot.update());
+    EXPECT_EQ(40.0f, snapshot.current().noise);
+    EXPECT_EQ(10.0f, snapshot.current().envAttack);
+    EXPECT_EQ(1.0f, snapshot.current().octave);
+}
+
+TEST(ParameterSnapshotTests, invalidate_test)
+{
+    Sources sources;
+    ParameterSnapshot snapshot;
+    sources.connect(snapshot);
+    snapshot.update();
+
+    snapshot.invalidate();
+    EXPECT_EQ(SynthParameters::ALL_CHANGED, snapshot.update());
+    EXPECT_EQ(0u, snapshot.update());
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "ParameterTables.h"
+
+TEST(ParameterTablesTests, tableExp_test)
+{
+    for (double x = -20.0; x <= 20.0; x += 0.01) {
+        EXPECT_NEAR(1.0, tableExp(x) / std::exp(x), 1.0e-14) << x;
+    }
+    static_assert(tableExp(0.0) == 1.0);
+}
+
+TEST(ParameterTablesTests, notePeriodFactors_test)
+{
+    // the same floats the formula gives, so note-ons sound exactly as they did
+    for (int drift = 0; drift < ANALOG_DRIFT_VOICES; ++drift) {
+        for (int note = 0; note < NUM_NOTES; ++note) {
+            const float expected = std::exp(NOTE_PERIOD_SCALE * float(note) + ANALOG_DRIFT * float(drift));
+            EXPECT_FLOAT_EQ(expected, NOTE_PERIOD_FACTORS[size_t(drift)][size_t(note)]) << drift << ", " << note;
+        }
+    }
+}
+
+TEST(ParameterTablesTests, envelopeRates_test)
+{
+    for (int percentage = 0; percentage <= ENVELOPE_STEPS; ++percentage) {
+        EXPECT_FLOAT_EQ(std::exp(5.5f - 0.075f * float(percentage)), envelopeRate(float(percentage))) << percentage;
+    }
+    // between the steps, and outside them, it falls back on the formula
+    EXPECT_EQ(std::exp(5.5f - 0.075f * 12.5f), envelopeRate(12.5f));
+    EXPECT_EQ(std::exp(5.5f - 0.075f * 150.0f), envelopeRate(150.0f));
+}
+
+TEST(ParameterTablesTests, envelopeMultipliers_test)
+{
+    for (const float sampleRate : { 44100.0f, 96000.0f }) {
+        const float inverseSampleRate = 1.0f / sampleRate;
+        EnvelopeMultipliers multipliers;
+        multipliers.prepare(inverseSampleRate);
+        for (const float percentage : { 0.0f, 1.0f, 30.0f, 50.0f, 99.5f, 100.0f }) {
+            const float expected = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * percentage));
+            EXPECT_FLOAT_EQ(expected, multipliers(percentage)) << sampleRate << ", " << percentage;
+        }
+    }
+}
+
+TEST(ParameterTablesTests, pitchBendRatio_test)
+{
+    EXPECT_EQ(1.0f, pitchBendRatio(0, 64));
+    // exactly the formula the synth always used, so a bend doesn't move the phase by an ulp
+    for (int bend = 0; bend < 16384; ++bend) {
+        const float expected = std::exp(-0.000014102f * float(bend - 8192));
+        EXPECT_EQ(expected, pitchBendRatio(uint8_t(bend & 0x7F), uint8_t(bend >> 7))) << bend;
+    }
+    // two semitones either way
+    EXPECT_NEAR(std::exp2(2.0f / 12.0f), pitchBendRatio(0, 0), 1.0e-4f);
+    EXPECT_NEAR(std::exp2(-2.0f / 12.0f), pitchBendRatio(127, 127), 1.0e-4f);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "PolyBLEPOscillator.h"
+#include <complex>
+#include <vector>
+
+// Helper function to render the oscillator one sample at a time
+std::vector<float> renderPolyBLEP(const PolyBLEPOscillator::Waveform waveform, const float period, const int numberOfSamples)
+{
+    PolyBLEPOscillator osc;
+    osc.reset();
+    osc.waveform = waveform;
+    osc.period = period;
+    std::vector<float> output(static_cast<size_t>(numberOfSamples));
+    for (auto& sample : output) {
+        sample = osc.nextSample();
+    }
+    return output;
+}
+
+// Helper function for the same waveform without any correction.
+// Sample n is at phase (n + 1) / period, as the oscillator advances before it outputs.
+std::vector<float> renderNaive(const PolyBLEPOscillator::Waveform waveform, const float period, const int numberOfSamples)
+{
+    std::vector<float> output(static_cast<size_t>(numberOfSamples));
+    for (int n = 0; n < numberOfSamples; ++n) {
+        const double t = double(n + 1) / period;
+        const double phase = t - std::floor(t);
+        switch (waveform) {
+            case PolyBLEPOscillator::Waveform::Square: output[size_t(n)] = phase < 0.5 ? 1.0f : -1.0f; break;
+            case PolyBLEPOscillator::Waveform::Triangle: output[size_t(n)] = float(1.0 - 4.0 * std::abs(phase - 0.5)); break;
+            case PolyBLEPOscillator::Waveform::Saw: output[size_t(n)] = float(2.0 * phase - 1.0); break;
+        }
+    }
+    return output;
+}
+
+// Helper function to measure aliasing. The signal holds a whole number of cycles, so its harmonics
+// fall exactly on every cyclesth bin of a DFT and anything in the other bins is aliasing.
+// Returns the energy of the aliases relative to the harmonics.
+double aliasingRatio(const std::vector<float>& signal, const int cycles)
+{
+    const size_t size = signal.size();
+    double harmonicEnergy = 0.0;
+    double aliasEnergy = 0.0;
+    for (size_t bin = 1; bin <= size / 2; ++bin) {
+        // rotate a phasor rather than calling sin and cos for every sample
+        const double angle = -2.0 * 3.14159265358979323846 * double(bin) / double(size);
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        std::complex<double> phasor(1.0, 0.0);
+        std::complex<double> sum(0.0, 0.0);
+        for (const float sample : signal) {
+            sum += double(sample) * phasor;
+            phasor *= step;
+        }
+        const double energy = std::norm(sum);
+        if (bin % size_t(cycles) == 0) { harmonicEnergy += energy; } else { aliasEnergy += energy; }
+    }
+    return aliasEnergy / harmonicEnergy;
+}
+
+TEST(PolyBLEPOscillatorTests, lessAliasingThanNaive_test)
+{
+    const int numberOfSamples = 2048;
+    const int cycles = 47;
+    const float period = float(numberOfSamples) / float(cycles);
+    for (const auto waveform : { PolyBLEPOscillator::Waveform::Saw, PolyBLEPOscillator::Waveform::Square,
+                                 PolyBLEPOscillator::Waveform::Triangle }) {
+        const auto polyBlep = renderPolyBLEP(waveform, period, numberOfSamples);
+        const auto naive = renderNaive(waveform, period, numberOfSamples);
+        EXPECT_LT(aliasingRatio(polyBlep, cycles), 0.1 * aliasingRatio(naive, cycles));
+    }
+}
+
+TEST(PolyBLEPOscillatorTests, renderBlockMatchesNextSample_test)
+{
+    for (const auto waveform : { PolyBLEPOscillator::Waveform::Saw, PolyBLEPOscillator::Waveform::Square,
+                                 PolyBLEPOscillator::Waveform::Triangle }) {
+        PolyBLEPOscillator osc;
+        osc.reset();
+        osc.waveform = waveform;
+        osc.amplitude = 0.5f;
+        osc.period = 91.7f;
+
+        std::vector<float> block(300);
+        osc.renderBlock(block.data(), 100);
+        osc.renderBlock(block.data() + 100, 200);
+
+        auto expected = renderPolyBLEP(waveform, 91.7f, 300);
+        // the phase is rounded differently, which shows most on the steep corrections
+        for (size_t i = 0; i < block.size(); ++i) {
+            EXPECT_NEAR(0.5f * expected[i], block[i], 1e-3f);
+        }
+    }
+}
+
+TEST(PolyBLEPOscillatorTests, highNotes_test)
+{
+    // no need to fold high notes down an octave, and above Nyquist it stays finite
+    for (const float period : { 2.5f, 3.0f, 5.0f, 1.0f }) {
+        for (const auto sample : renderPolyBLEP(PolyBLEPOscillator::Waveform::Saw, period, 100)) {
+            EXPECT_TRUE(std::isfinite(sample));
+            EXPECT_LE(std::abs(sample), 1.5f);
+        }
+    }
+}
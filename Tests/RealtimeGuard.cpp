@@ -0,0 +1,169 @@
+//
+// The replacement allocation and locking functions behind RealtimeGuard.h. Only counting happens
+// here: the memory and locks come from the C library as usual.
+//
+
+#include "RealtimeGuard.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+    #include <dlfcn.h>
+    #include <pthread.h>
+    #define JX11_REALTIME_CHECKS_GLIBC 1
+    // glibc's own entry points, so the replacements can pass calls on without calling themselves
+    extern "C" void* __libc_malloc(size_t size);
+    extern "C" void* __libc_calloc(size_t count, size_t size);
+    extern "C" void* __libc_realloc(void* pointer, size_t size);
+    extern "C" void* __libc_memalign(size_t alignment, size_t size);
+    extern "C" void __libc_free(void* pointer);
+#else
+    #define JX11_REALTIME_CHECKS_GLIBC 0
+#endif
+
+namespace
+{
+    std::atomic<bool> checking { false };
+    std::atomic<int> allocations { 0 };
+    std::atomic<int> deallocations { 0 };
+    std::atomic<int> locks { 0 };
+
+    void count(std::atomic<int>& counter)
+    {
+        if (checking.load(std::memory_order_relaxed)) { counter.fetch_add(1, std::memory_order_relaxed); }
+    }
+
+    void* allocate(const size_t size)
+    {
+        count(allocations);
+    #if JX11_REALTIME_CHECKS_GLIBC
+        return __libc_malloc(size == 0 ? 1 : size);
+    #else
+        return std::malloc(size == 0 ? 1 : size);
+    #endif
+    }
+
+    void* allocateAligned(const size_t size, const size_t alignment)
+    {
+        count(allocations);
+    #if JX11_REALTIME_CHECKS_GLIBC
+        return __libc_memalign(alignment, size == 0 ? 1 : size);
+    #else
+        // aligned_alloc wants a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    #endif
+    }
+
+    void release(void* pointer)
+    {
+        if (pointer == nullptr) { return; }
+        count(deallocations);
+    #if JX11_REALTIME_CHECKS_GLIBC
+        __libc_free(pointer);
+    #else
+        std::free(pointer);
+    #endif
+    }
+
+    void* allocateOrThrow(const size_t size)
+    {
+        void* pointer = allocate(size);
+        if (pointer == nullptr) { throw std::bad_alloc(); }
+        return pointer;
+    }
+
+    void* allocateAlignedOrThrow(const size_t size, const size_t alignment)
+    {
+        void* pointer = allocateAligned(size, alignment);
+        if (pointer == nullptr) { throw std::bad_alloc(); }
+        return pointer;
+    }
+}
+
+RealtimeScope::RealtimeScope()
+{
+    allocations.store(0);
+    deallocations.store(0);
+    locks.store(0);
+    checking.store(true);
+}
+
+RealtimeScope::~RealtimeScope()
+{
+    checking.store(false);
+}
+
+RealtimeViolations RealtimeScope::violations() const
+{
+    RealtimeViolations result;
+    result.allocations = allocations.load();
+    result.deallocations = deallocations.load();
+    result.locks = locks.load();
+    return result;
+}
+
+bool realtimeChecksCatchMallocAndLocks()
+{
+    return JX11_REALTIME_CHECKS_GLIBC != 0;
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, size_t(alignment)); }
+
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { release(pointer); }
+
+#if JX11_REALTIME_CHECKS_GLIBC
+// glibc declares these noexcept
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        count(allocations);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t numElements, size_t size) noexcept
+    {
+        count(allocations);
+        return __libc_calloc(numElements, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        count(allocations);
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr) { count(deallocations); }
+        __libc_free(pointer);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        // glibc doesn't let programs link to its own __pthread_mutex_lock, so look up the next one along
+        using Lock = int (*)(pthread_mutex_t*);
+        static std::atomic<Lock> next { nullptr };
+        Lock lock = next.load(std::memory_order_relaxed);
+        if (lock == nullptr) {
+            lock = reinterpret_cast<Lock>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            next.store(lock, std::memory_order_relaxed);
+        }
+        count(locks);
+        return lock(mutex);
+    }
+}
+#endif
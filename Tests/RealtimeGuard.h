@@ -0,0 +1,58 @@
+//
+// Catches heap allocations and mutex locks in code that has to be real-time safe.
+//
+// RealtimeGuard.cpp replaces operator new and delete for the whole test program, and with glibc
+// malloc, calloc, realloc, free and pthread_mutex_lock too (std::mutex locks through that). They
+// count what's called, from any thread, while a RealtimeScope is alive. Built in when the
+// JX11_REALTIME_CHECKS CMake option is on.
+//
+
+#ifndef REALTIME_GUARD_H
+#define REALTIME_GUARD_H
+
+#include <ostream>
+
+struct RealtimeViolations
+{
+    int allocations = 0;
+    int deallocations = 0;
+    int locks = 0;
+
+    bool operator==(const RealtimeViolations& other) const
+    {
+        return allocations == other.allocations && deallocations == other.deallocations && locks == other.locks;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& stream, const RealtimeViolations& violations)
+{
+    return stream << violations.allocations << " allocations, " << violations.deallocations << " deallocations, "
+                  << violations.locks << " locks";
+}
+
+// Counts violations from when it is made until it is destroyed. Scopes can't overlap.
+class RealtimeScope
+{
+public:
+    RealtimeScope();
+    ~RealtimeScope();
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+    RealtimeViolations violations() const;
+};
+
+// Whether malloc and mutexes are caught as well as operator new and delete on this platform
+bool realtimeChecksCatchMallocAndLocks();
+
+// Runs a function in a RealtimeScope and returns what it did wrong, for
+// EXPECT_EQ(RealtimeViolations {}, runRealtime([&] { ... }))
+template <typename Function>
+RealtimeViolations runRealtime(Function&& function)
+{
+    RealtimeScope scope;
+    function();
+    return scope.violations();
+}
+
+#endif //REALTIME_GUARD_H
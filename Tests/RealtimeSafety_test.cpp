@@ -0,0 +1,251 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "RealtimeGuard.h"
+#include "OutputSafety.h"
+#include "ParameterSnapshot.h"
+#include "MultiTimbralSynth.h"
+#include "RenderTelemetry.h"
+#include "Synth.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct MidiEvent
+    {
+        int sample;
+        uint8_t data0, data1, data2;
+    };
+
+    // Does what JX11AudioProcessor::processBlock does each block, without the plugin host:
+    // read the parameters, render between the MIDI events, then the safety stage and telemetry
+    class AudioPath
+    {
+    public:
+        std::array<std::atomic<float>, SynthParameters::COUNT> parameterValues;
+
+        AudioPath(const int renderThreads, const int oversampling)
+        {
+            const SynthParameters defaults;
+            for (int index = 0; index < SynthParameters::COUNT; index++) {
+                parameterValues[size_t(index)].store(defaults.*SynthParameters::entries[size_t(index)].value);
+                parameters.setSource(index, &parameterValues[size_t(index)]);
+            }
+            synth.setRenderThreads(renderThreads);
+            synth.setOversampling(oversampling);
+        }
+
+        ~AudioPath()
+        {
+            synth.deallocateResources();
+        }
+
+        // as prepareToPlay, so allowed to allocate
+        void prepare(const double newSampleRate, const int maxBlockSize)
+        {
+            sampleRate = newSampleRate;
+            synth.allocateResources(sampleRate, maxBlockSize);
+            parameters.invalidate();
+            synth.reset();
+            telemetry.prepare(sampleRate);
+            left.assign(size_t(maxBlockSize), 0.0f);
+            right.assign(size_t(maxBlockSize), 0.0f);
+        }
+
+        void set(float SynthParameters::* parameter, const float value)
+        {
+            for (int index = 0; index < SynthParameters::COUNT; index++) {
+                if (SynthParameters::entries[size_t(index)].value == parameter) { parameterValues[size_t(index)].store(value); }
+            }
+        }
+
+        void processBlock(const int sampleCount, const std::vector<MidiEvent>& events)
+        {
+            const auto blockStart = RenderTelemetry::startBlock();
+            const auto changed = parameters.update();
+            if (changed != 0) { parameters.current().applyTo(synth, float(sampleRate), changed); }
+
+            int offset = 0;
+            for (const auto& event : events) {
+                if (event.sample > offset) {
+                    render(offset, event.sample - offset);
+                    offset = event.sample;
+                }
+                synth.midiMessages(event.data0, event.data1, event.data2);
+            }
+            if (sampleCount > offset) { render(offset, sampleCount - offset); }
+
+            float* channels[2] = { left.data(), right.data() };
+            outputSafety.process(channels, 2, sampleCount);
+            telemetry.endBlock(blockStart, sampleCount, synth.getActiveVoiceCount(), synth.getVoicesStolen(),
+                               outputSafety.counters());
+        }
+
+    private:
+        Synth synth;
+        ParameterSnapshot parameters;
+        OutputSafety outputSafety;
+        RenderTelemetry telemetry;
+        double sampleRate = 48000.0;
+        std::vector<float> left, right;
+
+        void render(const int offset, const int sampleCount)
+        {
+            float* outputBuffers[2] = { left.data() + offset, right.data() + offset };
+            synth.render(outputBuffers, sampleCount);
+        }
+    };
+
+    // a block's worth of note ons and offs, a few samples apart, with the pedal going down and up
+    std::vector<MidiEvent> noteStorm(const int block, const int blockSize)
+    {
+        std::vector<MidiEvent> events;
+        for (int i = 0; i < 48; i++) {
+            const int sample = i * blockSize / 48;
+            const uint8_t note = uint8_t((block * 5 + i * 7) % 128);
+            events.push_back({ sample, 0x90, note, uint8_t(1 + (i * 13) % 127) });
+            events.push_back({ sample, 0x80, uint8_t((note + 60) % 128), 0 });
+            if (i % 12 == 0) { events.push_back({ sample, 0xB0, 0x40, uint8_t((i % 24 == 0) ? 127 : 0) }); }
+        }
+        events.push_back({ blockSize / 2, 0xE0, 0, uint8_t(block % 128) });
+        if (block % 10 == 9) { events.push_back({ blockSize - 1, 0xB0, 0x78, 0 }); } // panic
+        return events;
+    }
+}
+
+TEST(RealtimeSafetyTests, guardCatchesViolations_test)
+{
+    const auto allocating = runRealtime([] {
+        std::vector<float> buffer(64);
+        buffer[0] = 1.0f;
+    });
+    EXPECT_EQ(1, allocating.allocations);
+    EXPECT_EQ(1, allocating.deallocations);
+
+    if (realtimeChecksCatchMallocAndLocks()) {
+        std::mutex mutex;
+        const auto locking = runRealtime([&mutex] {
+            const std::lock_guard<std::mutex> lock(mutex);
+        });
+        EXPECT_EQ(1, locking.locks);
+
+        const auto mallocing = runRealtime([] {
+            // volatile, or the compiler drops the pair
+            void* volatile pointer = std::malloc(16);
+            std::free(pointer);
+        });
+        EXPECT_EQ(1, mallocing.allocations);
+    }
+
+    EXPECT_EQ(RealtimeViolations {}, runRealtime([] {}));
+}
+
+TEST(RealtimeSafetyTests, noteStorm_test)
+{
+    constexpr int blockSize = 256;
+    AudioPath path(0, 1);
+    path.prepare(48000.0, blockSize);
+    path.set(&SynthParameters::polyMode, 1.0f);
+
+    std::vector<std::vector<MidiEvent>> blocks;
+    for (int block = 0; block < 40; block++) { blocks.push_back(noteStorm(block, blockSize)); }
+
+    EXPECT_EQ(RealtimeViolations {}, runRealtime([&] {
+        for (const auto& events : blocks) { path.processBlock(blockSize, events); }
+    }));
+}
+
+TEST(RealtimeSafetyTests, parameterAutomation_test)
+{
+    constexpr int blockSize = 128;
+    AudioPath path(0, 1);
+    path.prepare(48000.0, blockSize);
+    const std::vector<MidiEvent> chord { { 0, 0x90, 48, 100 }, { 0, 0x90, 55, 100 }, { 0, 0x90, 64, 100 } };
+    const std::vector<MidiEvent> none;
+
+    EXPECT_EQ(RealtimeViolations {}, runRealtime([&] {
+        for (int block = 0; block < 200; block++) {
+            const float sweep = float(block % 100) / 100.0f;
+            path.set(&SynthParameters::lfoRate, sweep);
+            path.set(&SynthParameters::noise, 100.0f * sweep);
+            path.set(&SynthParameters::outputLevel, -24.0f * sweep);
+            path.set(&SynthParameters::envAttack, 100.0f * sweep);
+            path.set(&SynthParameters::envRelease, 100.0f * (1.0f - sweep));
+            path.set(&SynthParameters::oscTune, -24.0f + 48.0f * sweep);
+            path.set(&SynthParameters::filterVelocity, -100.0f + 200.0f * sweep);
+            path.set(&SynthParameters::polyMode, float(block / 50 % 2));
+            path.processBlock(blockSize, (block % 50 == 0) ? chord : none);
+        }
+    }));
+}
+
+TEST(RealtimeSafetyTests, sampleRateChanges_test)
+{
+    // each change of rate and block size is a prepareToPlay, which may allocate, but the blocks after it may not
+    AudioPath path(0, 2);
+    const std::vector<MidiEvent> chord { { 0, 0x90, 60, 100 }, { 0, 0x90, 67, 90 } };
+    const std::vector<MidiEvent> none;
+    for (const auto& [sampleRate, blockSize] : { std::pair { 44100.0, 512 }, { 96000.0, 64 }, { 48000.0, 1024 } }) {
+        path.prepare(sampleRate, blockSize);
+        EXPECT_EQ(RealtimeViolations {}, runRealtime([&] {
+            for (int block = 0; block < 20; block++) {
+                // hosts may pass shorter blocks than they prepared for
+                const int sampleCount = (block % 3 == 2) ? blockSize / 3 : blockSize;
+                path.processBlock(sampleCount, (block == 0) ? chord : none);
+            }
+        })) << sampleRate;
+    }
+}
+
+TEST(RealtimeSafetyTests, renderThreads_test)
+{
+    constexpr int blockSize = 256;
+    AudioPath path(3, 2);
+    path.prepare(48000.0, blockSize);
+    path.set(&SynthParameters::polyMode, 1.0f);
+
+    std::vector<std::vector<MidiEvent>> blocks;
+    for (int block = 0; block < 40; block++) { blocks.push_back(noteStorm(block, blockSize)); }
+
+    EXPECT_EQ(RealtimeViolations {}, runRealtime([&] {
+        for (const auto& events : blocks) { path.processBlock(blockSize, events); }
+    }));
+}
+
+TEST(RealtimeSafetyTests, multiTimbral_test)
+{
+    constexpr int blockSize = 256;
+    MultiTimbralSynth multiSynth;
+    for (int channel = 0; channel < 4; channel++) {
+        multiSynth.setPartEnabled(channel, true);
+        multiSynth.setPartBus(channel, channel % 2);
+    }
+    multiSynth.setRenderThreads(2);
+    multiSynth.allocateResources(48000.0, blockSize);
+    multiSynth.reset();
+
+    std::vector<std::vector<MidiEvent>> blocks;
+    for (int block = 0; block < 40; block++) { blocks.push_back(noteStorm(block, blockSize)); }
+    std::vector<float> outputs(static_cast<size_t>(4 * blockSize));
+    float* channels[4] = { outputs.data(), outputs.data() + blockSize, outputs.data() + 2 * blockSize,
+                           outputs.data() + 3 * blockSize };
+    SynthParameters patch;
+
+    EXPECT_EQ(RealtimeViolations {}, runRealtime([&] {
+        for (size_t block = 0; block < blocks.size(); block++) {
+            // the storm spread over the parts, with a patch change now and then
+            for (const auto& event : blocks[block]) {
+                multiSynth.midiMessages(uint8_t(event.data0 | (event.data1 % 4)), event.data1, event.data2);
+            }
+            if (block % 8 == 0) {
+                patch.filterFreq = float(block);
+                multiSynth.setPartParameters(int(block / 8) % 4, patch);
+            }
+            multiSynth.render(channels, 4, blockSize);
+        }
+    }));
+    multiSynth.deallocateResources();
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "RenderTelemetry.h"
+#include "SpscRing.h"
+#include <thread>
+
+TEST(SpscRingTests, firstInFirstOut_test)
+{
+    SpscRing<int, 4> ring;
+    int item = 0;
+    EXPECT_FALSE(ring.pop(item));
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(4)); // full, so dropped
+    EXPECT_EQ(4u, ring.size());
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.pop(item));
+        EXPECT_EQ(i, item);
+    }
+    EXPECT_FALSE(ring.pop(item));
+    EXPECT_TRUE(ring.push(5));
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(5, item);
+}
+
+TEST(SpscRingTests, betweenThreads_test)
+{
+    // every item arrives once and in order, with the producer retrying when the ring is full
+    constexpr int count = 100000;
+    SpscRing<int, 64> ring;
+    std::thread producer([&ring] {
+        for (int i = 0; i < count; i++) {
+            while (!ring.push(i)) { std::this_thread::yield(); }
+        }
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        int item;
+        if (ring.pop(item)) {
+            ASSERT_EQ(expected, item);
+            expected++;
+        }
+    }
+    producer.join();
+}
+
+TEST(RenderTelemetryTests, summarisesBlocks_test)
+{
+    RenderTelemetry telemetry;
+    telemetry.prepare(48000.0);
+    OutputSafety::Counters safety;
+
+    // an hour long block can't overrun, while a one sample block will
+    telemetry.endBlock(RenderTelemetry::startBlock(), 48000 * 3600, 3, 0, safety);
+    safety.clampedSamples = 5;
+    safety.mutedBlocks = 1;
+    telemetry.endBlock(RenderTelemetry::startBlock() - std::chrono::milliseconds(1), 1, 5, 2, safety);
+    telemetry.endBlock(RenderTelemetry::startBlock(), 48000 * 3600, 4, 3, safety);
+
+    EXPECT_EQ(0u, telemetry.summary().blocks); // nothing until it's polled
+    EXPECT_EQ(3, telemetry.poll());
+
+    const auto& summary = telemetry.summary();
+    EXPECT_EQ(3u, summary.blocks);
+    EXPECT_GE(summary.peakLoad, 1.0f);
+    EXPECT_EQ(2u, summary.loadHistogram[0]);
+    EXPECT_EQ(1u, summary.loadHistogram[RenderTelemetry::HISTOGRAM_BUCKETS - 1]);
+    EXPECT_EQ(1u, telemetry.getOverruns());
+    EXPECT_EQ(4, summary.activeVoices);
+    EXPECT_EQ(5, summary.maxActiveVoices);
+    EXPECT_EQ(3u, summary.voicesStolen);
+    EXPECT_EQ(1u, summary.mutedBlocks);
+    EXPECT_EQ(5u, summary.clampedSamples);
+    EXPECT_GT(summary.averageLoad(), 0.0);
+    EXPECT_LT(summary.averageLoad(), 1.0);
+
+    telemetry.resetSummary();
+    EXPECT_EQ(0u, telemetry.summary().blocks);
+}
+
+TEST(RenderTelemetryTests, countsDroppedRecords_test)
+{
+    RenderTelemetry telemetry;
+    telemetry.prepare(48000.0);
+    for (size_t i = 0; i < RenderTelemetry::RING_SIZE + 10; i++) {
+        telemetry.endBlock(RenderTelemetry::startBlock(), 512, 0, 0, {});
+    }
+    EXPECT_EQ(10u, telemetry.getDroppedRecords());
+    EXPECT_EQ(int(RenderTelemetry::RING_SIZE), telemetry.poll());
+}
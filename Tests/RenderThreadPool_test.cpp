@@ -0,0 +1,101 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "RenderThreadPool.h"
+#include "Synth.h"
+
+namespace
+{
+    struct TaskCounts
+    {
+        std::array<std::atomic<int>, 100> counts {};
+    };
+
+    void countTask(void* context, const int taskIndex)
+    {
+        static_cast<TaskCounts*>(context)->counts[size_t(taskIndex)].fetch_add(1);
+    }
+
+    // Renders a few notes with the given number of render threads
+    std::vector<float> renderChord(const int numThreads, const bool noisePerVoice = false)
+    {
+        Synth synth;
+        synth.setRenderThreads(numThreads);
+        synth.setNoisePerVoice(noisePerVoice);
+        synth.allocateResources(44100.0, 256);
+        synth.reset();
+        synth.setSampleRate(44100.0f);
+        synth.numVoices = Synth::MAX_VOICES;
+        synth.envAttack = 0.99f;
+        synth.envDecay = 0.9999f;
+        synth.envSustain = 0.5f;
+        synth.envRelease = 0.999f;
+        synth.oscMix = 0.5f;
+        synth.detune = 1.01f;
+        synth.tune = 1.0f;
+        synth.volumeTrim = 0.001f;
+        synth.outputLevel = 1.0f;
+        synth.noiseMix = 0.01f;
+        synth.lfoInc = 0.01f;
+
+        std::vector<float> output;
+        std::vector<float> left(256), right(256);
+        for (int block = 0; block < 40; ++block) {
+            if (block < Synth::MAX_VOICES && block < 12) {
+                synth.midiMessages(0x90, uint8_t(48 + 3 * block), 100);
+            }
+            float* outputBuffers[2] = { left.data(), right.data() };
+            synth.render(outputBuffers, 256);
+            output.insert(output.end(), left.begin(), left.end());
+            output.insert(output.end(), right.begin(), right.end());
+        }
+        return output;
+    }
+}
+
+TEST(RenderThreadPoolTests, runsEveryTaskOnce_test)
+{
+    RenderThreadPool pool;
+    pool.start(3);
+    EXPECT_EQ(3, pool.getNumWorkers());
+
+    TaskCounts taskCounts;
+    for (int run = 0; run < 1000; ++run) {
+        pool.run(countTask, &taskCounts, 1 + run % 100);
+    }
+    pool.stop();
+
+    for (int taskIndex = 0; taskIndex < 100; ++taskIndex) {
+        EXPECT_EQ(1000 - 10 * taskIndex, taskCounts.counts[size_t(taskIndex)].load());
+    }
+}
+
+TEST(RenderThreadPoolTests, runsOnCallingThreadWithoutWorkers_test)
+{
+    RenderThreadPool pool;
+    TaskCounts taskCounts;
+    pool.run(countTask, &taskCounts, 10);
+    for (int taskIndex = 0; taskIndex < 10; ++taskIndex) {
+        EXPECT_EQ(1, taskCounts.counts[size_t(taskIndex)].load());
+    }
+}
+
+TEST(RenderThreadPoolTests, parallelRenderMatchesSerial_test)
+{
+    const auto serial = renderChord(0);
+    const auto parallel = renderChord(2);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i], parallel[i]);
+    }
+}
+
+TEST(RenderThreadPoolTests, parallelPerVoiceNoiseMatchesSerial_test)
+{
+    const auto serial = renderChord(0, true);
+    const auto parallel = renderChord(2, true);
+    EXPECT_NE(renderChord(0), serial);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i], parallel[i]);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "Sinc.h"
+
+// Helper function to find the largest difference from the exact sinc that the oscillator has always used,
+// over the range of phases the oscillators can reach
+template <typename Function>
+float maxSincError(Function&& sinc)
+{
+    float maxError = 0.0f;
+    for (float x = -10.0f; x < 40000.0f; x += 0.0123f) {
+        if (x == 0.0f) { continue; }
+        maxError = std::max(maxError, std::abs(sinc(x) - sincExact(x)));
+    }
+    return maxError;
+}
+
+TEST(SincTests, tableAccuracy_test)
+{
+    EXPECT_LT(maxSincError(sincTable), 2.0e-7f);
+}
+
+TEST(SincTests, polynomialAccuracy_test)
+{
+    EXPECT_LT(maxSincError(sincPolynomial), 1.5e-7f);
+}
+
+TEST(SincTests, centreOfImpulse_test)
+{
+    // no divide near zero, so no blow up
+    EXPECT_NEAR(1.0f, sincTable(0.0f), 2e-7f);
+    EXPECT_EQ(1.0f, sincPolynomial(0.0f));
+    EXPECT_NEAR(sincExact(1e-4f), sincTable(-1e-4f), 2e-7f);
+    EXPECT_NEAR(sincExact(-1e-4f), sincPolynomial(-1e-4f), 1.5e-7f);
+}
+
+TEST(SincTests, zeroCrossings_test)
+{
+    // sin(x) / x is zero at every multiple of pi
+    for (int n = 1; n < 10000; n += 7) {
+        const float x = float(n * SINC_PI);
+        EXPECT_NEAR(0.0f, sincTable(x), 1e-7f);
+        EXPECT_NEAR(0.0f, sincPolynomial(x), 1e-7f);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "SynthParameters.h"
+
+TEST(SynthParametersTests, setById_test)
+{
+    SynthParameters parameters;
+    EXPECT_TRUE(parameters.set("noise", 50.0f));
+    EXPECT_EQ(50.0f, parameters.noise);
+    EXPECT_TRUE(parameters.set("filterLFO", 20.0f));
+    EXPECT_EQ(20.0f, parameters.filterLFO);
+    EXPECT_FALSE(parameters.set("notAParameter", 1.0f));
+}
+
+TEST(SynthParametersTests, applyTo_test)
+{
+    Synth synth;
+    SynthParameters parameters;
+    parameters.applyTo(synth, 48000.0f);
+
+    // the plugin's defaults
+    EXPECT_EQ(Synth::MAX_VOICES, synth.numVoices);
+    EXPECT_FLOAT_EQ(1.0f, synth.outputLevel);
+    EXPECT_FLOAT_EQ(0.0f, synth.noiseMix);
+    EXPECT_NEAR(2.0f, synth.detune, 0.0001f); // an octave down
+    EXPECT_FALSE(synth.ignoreVelocity);
+
+    parameters.polyMode = 0.0f;
+    parameters.outputLevel = -6.0f;
+    parameters.filterVelocity = -100.0f;
+    parameters.applyTo(synth, 48000.0f);
+    EXPECT_EQ(1, synth.numVoices);
+    EXPECT_NEAR(0.501f, synth.outputLevel, 0.001f);
+    EXPECT_TRUE(synth.ignoreVelocity);
+}
+
+TEST(SynthParametersTests, differences_test)
+{
+    SynthParameters parameters;
+    SynthParameters other;
+    EXPECT_EQ(0u, parameters.differences(other));
+
+    other.noise = 50.0f;
+    other.octave = 1.0f;
+    EXPECT_EQ(SynthParameters::maskOf(&SynthParameters::noise) | SynthParameters::maskOf(&SynthParameters::octave),
+              parameters.differences(other));
+    EXPECT_NE(0u, SynthParameters::maskOf(&SynthParameters::outputLevel));
+}
+
+TEST(SynthParametersTests, applyChanged_test)
+{
+    // applying only the changed parameters leaves the synth as a full update would
+    SynthParameters before;
+    SynthParameters after;
+    after.oscMix = 30.0f;
+    after.oscFine = 10.0f;
+    after.tuning = -20.0f;
+    after.lfoRate = 0.5f;
+    after.envRelease = 60.0f;
+
+    Synth updated;
+    before.applyTo(updated, 48000.0f);
+    after.applyTo(updated, 48000.0f, after.differences(before));
+
+    Synth full;
+    after.applyTo(full, 48000.0f);
+
+    EXPECT_EQ(full.oscMix, updated.oscMix);
+    EXPECT_EQ(full.detune, updated.detune);
+    EXPECT_EQ(full.tune, updated.tune);
+    EXPECT_EQ(full.lfoInc, updated.lfoInc);
+    EXPECT_EQ(full.envRelease, updated.envRelease);
+    EXPECT_EQ(full.envAttack, updated.envAttack);
+    EXPECT_EQ(full.volumeTrim, updated.volumeTrim);
+    EXPECT_EQ(full.outputLevel, updated.outputLevel);
+}
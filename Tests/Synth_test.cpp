@@ -1,57 +1,183 @@
 #pragma once
 #include <gtest/gtest.h>
 #include "Synth.h"
-#include "JuceHeader.h"
+#include "SynthParameters.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
-TEST(SynthTest, Constructor_test) {
-  Synth synth;
-  EXPECT_FLOAT_EQ(synth.sampleRate, 44100.0f);
+namespace
+{
+    constexpr double SYNTH_TEST_RATE = 48000.0;
+    constexpr int SYNTH_TEST_BLOCK = 256;
+
+    void setupSynth(Synth& synth, const int maxBlockSize = SYNTH_TEST_BLOCK)
+    {
+        synth.setOversampling(1);
+        synth.allocateResources(SYNTH_TEST_RATE, maxBlockSize);
+        synth.reset();
+        SynthParameters {}.applyTo(synth, float(SYNTH_TEST_RATE));
+    }
+
+    // Renders sampleCount samples in blocks of blockSize, into left and right
+    void renderBlocks(Synth& synth, std::vector<float>& left, std::vector<float>& right, const int sampleCount,
+                      const int blockSize)
+    {
+        left.assign(size_t(sampleCount), 0.0f);
+        right.assign(size_t(sampleCount), 0.0f);
+        for (int offset = 0; offset < sampleCount; offset += blockSize) {
+            float* outputBuffers[2] = { left.data() + offset, right.data() + offset };
+            synth.render(outputBuffers, std::min(blockSize, sampleCount - offset));
+        }
+    }
+
+    float peak(const std::vector<float>& samples)
+    {
+        float result = 0.0f;
+        for (const float sample : samples) { result = std::max(result, std::abs(sample)); }
+        return result;
+    }
+}
+
+TEST(SynthTest, silentWithoutNotes_test)
+{
+    Synth synth;
+    setupSynth(synth);
+    std::vector<float> left, right;
+    renderBlocks(synth, left, right, 4096, SYNTH_TEST_BLOCK);
+    EXPECT_EQ(0.0f, peak(left));
+    EXPECT_EQ(0.0f, peak(right));
+    EXPECT_EQ(0, synth.getActiveVoiceCount());
 }
 
+TEST(SynthTest, noteOnAndOff_test)
+{
+    Synth synth;
+    setupSynth(synth);
+    std::vector<float> left, right;
+
+    synth.midiMessages(0x90, 60, 100);
+    EXPECT_EQ(1, synth.getActiveVoiceCount());
+    renderBlocks(synth, left, right, 4800, SYNTH_TEST_BLOCK);
+    EXPECT_GT(peak(left), 0.01f);
+    EXPECT_GT(peak(right), 0.01f);
+    EXPECT_LT(peak(left), 1.0f);
+
+    // after the release has run its course the voice is freed and the output is silent
+    synth.midiMessages(0x80, 60, 0);
+    renderBlocks(synth, left, right, 48000, SYNTH_TEST_BLOCK);
+    EXPECT_EQ(0, synth.getActiveVoiceCount());
+    renderBlocks(synth, left, right, 1024, SYNTH_TEST_BLOCK);
+    EXPECT_EQ(0.0f, peak(left));
+}
 
-TEST(SynthTest, NoteOn_test) {
-  Synth synth = setupTest();
-  synth.noteOn(60, 127);
-  // This calls update() as well as env.attack() so need to make sure that these are done first
+TEST(SynthTest, blockSizeDoesNotChangeOutput_test)
+{
+    std::vector<float> referenceLeft, referenceRight, left, right;
+    for (const int blockSize : { 256, 1, 37, 100 }) {
+        Synth synth;
+        setupSynth(synth);
+        synth.midiMessages(0x90, 57, 100);
+        synth.midiMessages(0x90, 64, 80);
+        if (blockSize == 256) {
+            renderBlocks(synth, referenceLeft, referenceRight, 4800, blockSize);
+            continue;
+        }
+        // the envelopes are worked out in closed form from the start of each block, and a block of
+        // one sample is the old recurrence, which drifts by a few parts in 100000 over a note
+        renderBlocks(synth, left, right, 4800, blockSize);
+        for (size_t i = 0; i < left.size(); ++i) {
+            EXPECT_NEAR(referenceLeft[i], left[i], 1e-5f) << blockSize << ", " << i;
+            EXPECT_NEAR(referenceRight[i], right[i], 1e-5f) << blockSize << ", " << i;
+        }
+    }
 }
 
+TEST(SynthTest, resetRepeatsOutput_test)
+{
+    Synth synth;
+    setupSynth(synth);
+    std::vector<float> firstLeft, firstRight, secondLeft, secondRight;
 
+    synth.midiMessages(0x90, 48, 100);
+    renderBlocks(synth, firstLeft, firstRight, 4800, SYNTH_TEST_BLOCK);
 
-TEST(SynthTest, Render) {
-  Synth synth;
-  float outputBuffers[2][10] ;
-  int sampleCount = 10;
-  synth.render(outputBuffers, sampleCount);
+    synth.reset();
+    synth.midiMessages(0x90, 48, 100);
+    renderBlocks(synth, secondLeft, secondRight, 4800, SYNTH_TEST_BLOCK);
 
-  // Verify that the output buffers are not empty
-  for (int i = 0; i < sampleCount; i++) {
-    EXPECT_NE(outputBuffers[0][i], 0.0f);
-    EXPECT_NE(outputBuffers[1][i], 0.0f);
-  }
+    EXPECT_EQ(firstLeft, secondLeft);
+    EXPECT_EQ(firstRight, secondRight);
 }
 
-Synth setupTest() {
-  Synth synth;
-  synth.reset();
-  // Set all the variables of the synth
-  synth.envDecay = 0.1f;
-  synth.envAttack = 0.1f;
-  synth.envSustain = 0.5f;
-  synth.envRelease = 0.1f;
-  synth.oscMix = 0.5f;
-  synth.detune = 0.0f;
-  synth.oscFine = 0.0f;
-  synth.tune = 0.0f;
-  synth.pitchBend = 0.0f;
-
-  return Synth
+TEST(SynthTest, monoIsAverageOfStereo_test)
+{
+    Synth stereo, mono;
+    setupSynth(stereo);
+    setupSynth(mono);
+    stereo.midiMessages(0x90, 60, 100);
+    stereo.midiMessages(0x90, 67, 100);
+    mono.midiMessages(0x90, 60, 100);
+    mono.midiMessages(0x90, 67, 100);
+
+    std::vector<float> left(SYNTH_TEST_BLOCK), right(SYNTH_TEST_BLOCK), monoOutput(SYNTH_TEST_BLOCK);
+    float* stereoBuffers[2] = { left.data(), right.data() };
+    float* monoBuffers[2] = { monoOutput.data(), nullptr };
+    stereo.render(stereoBuffers, SYNTH_TEST_BLOCK);
+    mono.render(monoBuffers, SYNTH_TEST_BLOCK);
+
+    for (size_t i = 0; i < size_t(SYNTH_TEST_BLOCK); i++) {
+        EXPECT_FLOAT_EQ((left[i] + right[i]) * 0.5f, monoOutput[i]) << i;
+    }
 }
 
-float* outputBuffers setupBuffer(int numSamples) {
-  juce::AudioBuffer<float> buffer(2, numSamples);
-  buffer.clear();
-  float* outputBuffers[2] = { nullptr, nullptr };
-  outputBuffers[0] = buffer.getWritePointer(0);
-  outputBuffers[1] = buffer.getWritePointer(1);
-  return outputBuffers
-}
\ No newline at end of file
+TEST(SynthTest, perVoiceNoise_test)
+{
+    // one voice, then two, so both the single voice and the voice bank render the noise
+    const auto renderNoisyNotes = [] (const bool perVoice, const NoiseColour colour, const int blockSize,
+                                      std::vector<float>& left, std::vector<float>& right) {
+        Synth synth;
+        synth.setNoisePerVoice(perVoice);
+        synth.setNoiseColour(colour);
+        synth.setOversampling(1);
+        synth.allocateResources(SYNTH_TEST_RATE, SYNTH_TEST_BLOCK);
+        synth.reset();
+        SynthParameters patch;
+        patch.noise = 80.0f;
+        patch.applyTo(synth, float(SYNTH_TEST_RATE));
+
+        std::vector<float> secondLeft, secondRight;
+        synth.midiMessages(0x90, 57, 100);
+        renderBlocks(synth, left, right, 1024, blockSize);
+        synth.midiMessages(0x90, 64, 100);
+        renderBlocks(synth, secondLeft, secondRight, 2048, blockSize);
+        left.insert(left.end(), secondLeft.begin(), secondLeft.end());
+        right.insert(right.end(), secondRight.begin(), secondRight.end());
+    };
+
+    std::vector<float> sharedLeft, sharedRight, referenceLeft, referenceRight, left, right;
+    renderNoisyNotes(false, NoiseColour::White, SYNTH_TEST_BLOCK, sharedLeft, sharedRight);
+    for (const NoiseColour colour : { NoiseColour::White, NoiseColour::Pink }) {
+        renderNoisyNotes(true, colour, SYNTH_TEST_BLOCK, referenceLeft, referenceRight);
+        EXPECT_NE(sharedLeft, referenceLeft);
+        EXPECT_GT(peak(referenceLeft), 0.01f);
+
+        // the streams don't depend on how the audio is split into blocks, give or take the
+        // rounding of the noise level's ramp and of the envelopes
+        for (const int blockSize : { 1, 37, 100 }) {
+            renderNoisyNotes(true, colour, blockSize, left, right);
+            ASSERT_EQ(referenceLeft.size(), left.size());
+            for (size_t i = 0; i < left.size(); ++i) {
+                EXPECT_NEAR(referenceLeft[i], left[i], 1e-5f) << blockSize << ", " << i;
+                EXPECT_NEAR(referenceRight[i], right[i], 1e-5f) << blockSize << ", " << i;
+            }
+        }
+    }
+
+    // the setting only changes when the resources are allocated
+    Synth synth;
+    synth.setNoisePerVoice(true);
+    EXPECT_FALSE(synth.getNoisePerVoice());
+    setupSynth(synth);
+    EXPECT_TRUE(synth.getNoisePerVoice());
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "VoiceAllocator.h"
+#include <vector>
+
+namespace
+{
+    template <int NumVoices>
+    std::vector<int> heldVoices(const VoiceAllocator<NumVoices>& allocator, const int note)
+    {
+        std::vector<int> voices;
+        allocator.forEachHeld(note, [&voices] (const int voice) { voices.push_back(voice); });
+        return voices;
+    }
+
+    // starts a note on the voice the allocator picks, as the synth does
+    template <int NumVoices>
+    int play(VoiceAllocator<NumVoices>& allocator, const int note)
+    {
+        const int voice = allocator.allocate();
+        allocator.noteStarted(voice, note);
+        return voice;
+    }
+}
+
+TEST(VoiceAllocatorTests, usesIdleVoicesFirst_test)
+{
+    VoiceAllocator<130> allocator;
+    allocator.reset();
+    EXPECT_EQ(129, play(allocator, 60));
+    EXPECT_EQ(128, play(allocator, 62));
+
+    allocator.voiceFinished(129);
+    EXPECT_TRUE(allocator.isIdle(129));
+    EXPECT_EQ(129, allocator.allocate());
+}
+
+TEST(VoiceAllocatorTests, findsVoicesByNote_test)
+{
+    VoiceAllocator<8> allocator;
+    allocator.reset();
+    const int first = play(allocator, 60);
+    const int second = play(allocator, 60);
+    play(allocator, 64);
+
+    EXPECT_EQ((std::vector<int> { second, first }), heldVoices(allocator, 60));
+    EXPECT_TRUE(heldVoices(allocator, 61).empty());
+
+    // a released voice no longer plays its note
+    allocator.noteReleased(first);
+    EXPECT_EQ(std::vector<int> { second }, heldVoices(allocator, 60));
+    EXPECT_TRUE(allocator.isReleased(first));
+
+    // nor does a voice that is stolen for another
+    allocator.noteStarted(second, 72);
+    EXPECT_TRUE(heldVoices(allocator, 60).empty());
+    EXPECT_EQ(std::vector<int> { second }, heldVoices(allocator, 72));
+}
+
+TEST(VoiceAllocatorTests, sustainedVoices_test)
+{
+    VoiceAllocator<8> allocator;
+    allocator.reset();
+    const int first = play(allocator, 60);
+    const int second = play(allocator, 64);
+    allocator.noteSustained(first);
+    allocator.noteSustained(second);
+    EXPECT_TRUE(allocator.isSustained(first));
+    EXPECT_TRUE(heldVoices(allocator, 60).empty());
+
+    std::vector<int> sustained;
+    allocator.forEachSustained([&] (const int voice) {
+        sustained.push_back(voice);
+        allocator.noteReleased(voice);
+    });
+    EXPECT_EQ(2u, sustained.size());
+    EXPECT_TRUE(allocator.isReleased(first));
+    EXPECT_TRUE(allocator.isReleased(second));
+
+    int remaining = 0;
+    allocator.forEachSustained([&remaining] (int) { remaining++; });
+    EXPECT_EQ(0, remaining);
+}
+
+TEST(VoiceAllocatorTests, stealsOldestReleasedThenOldestHeld_test)
+{
+    VoiceAllocator<4> allocator;
+    allocator.reset();
+    const int a = play(allocator, 60);
+    const int b = play(allocator, 62);
+    const int c = play(allocator, 64);
+    const int d = play(allocator, 65);
+
+    // nothing released, so the oldest note goes
+    EXPECT_EQ(a, allocator.allocate());
+
+    // released voices go first, in the order they were released
+    allocator.noteReleased(c);
+    allocator.noteReleased(b);
+    EXPECT_EQ(c, allocator.allocate());
+    allocator.noteStarted(c, 67);
+    EXPECT_EQ(b, allocator.allocate());
+    allocator.noteStarted(b, 69);
+
+    // now the oldest held voice again, and a sustained voice keeps its place
+    allocator.noteSustained(a);
+    EXPECT_EQ(a, allocator.allocate());
+    allocator.voiceFinished(a);
+    EXPECT_EQ(a, play(allocator, 71));
+
+    // restarted voices go to the back of the queue, leaving d the oldest
+    EXPECT_EQ(d, allocator.allocate());
+}
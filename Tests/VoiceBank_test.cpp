@@ -0,0 +1,191 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "VoiceBank.h"
+#include "Helpers.h"
+
+// Helper function to setup a set of voices playing a chord
+template <int NumVoices>
+std::array<Voice, NumVoices> setupVoices()
+{
+    std::array<Voice, NumVoices> voices;
+    for (int i = 0; i < NumVoices; ++i) {
+        Voice& voice = voices[i];
+        voice.reset();
+        voice.note = 48 + 5 * i;
+        voice.update();
+        voice.setSampleRate(44100.0f);
+        voice.env.setAttack(10.0f);
+        voice.env.setDecay(50.0f);
+        voice.env.setSustain(50.0f);
+        voice.env.setRelease(50.0f);
+
+        voice.oscillator.amplitude = 0.25f;
+        voice.oscillator2.amplitude = 0.125f;
+        voice.oscillator.period = calculatePeriod(float(voice.note), 44100.0f);
+        voice.oscillator2.period = calculatePeriod(float(voice.note) + 7.0f, 44100.0f);
+
+        voice.filter.setSampleRate(44100.0f);
+        voice.filter.updateCoefficients(1000.0f, 0.707f);
+
+        // leave some of the voices silent
+        if (i % 3 != 2) {
+            voice.env.attack();
+        }
+    }
+    return voices;
+}
+
+TEST(VoiceBankTests, matchesVoiceRender_test)
+{
+    constexpr int numVoices = 6;
+    auto voices = setupVoices<numVoices>();
+    auto bankVoices = setupVoices<numVoices>();
+
+    VoiceBank<numVoices> bank;
+    bank.load(bankVoices);
+
+    const int numberOfSamples = 2000;
+    std::vector<float> noise(numberOfSamples, 0.01f);
+    std::vector<float> left(numberOfSamples), right(numberOfSamples);
+    bank.render(left.data(), right.data(), noise.data(), numberOfSamples);
+    bank.store(bankVoices);
+
+    // the bank evaluates the sinc with the polynomial, so they agree to within its error
+    for (int i = 0; i < numberOfSamples; ++i) {
+        float expectedLeft = 0.0f;
+        float expectedRight = 0.0f;
+        for (auto& voice : voices) {
+            if (voice.env.isActive()) {
+                const float sample = voice.render(noise[i]);
+                expectedLeft += sample * voice.panLeft;
+                expectedRight += sample * voice.panRight;
+            }
+        }
+        EXPECT_NEAR(expectedLeft, left[i], 1e-6f) << i;
+        EXPECT_NEAR(expectedRight, right[i], 1e-6f) << i;
+    }
+
+    for (int i = 0; i < numVoices; ++i) {
+        EXPECT_NEAR(voices[i].env.level, bankVoices[i].env.level, 1e-6f);
+        EXPECT_EQ(voices[i].oscillator.nextSample(), bankVoices[i].oscillator.nextSample());
+    }
+}
+
+TEST(VoiceBankTests, silentVoicesAreUntouched_test)
+{
+    constexpr int numVoices = 3;
+    auto voices = setupVoices<numVoices>();
+
+    VoiceBank<numVoices> bank;
+    bank.load(voices);
+    bank.setModulation(0.5f, 64);
+
+    float noise[64] = {};
+    float left[64], right[64];
+    bank.render(left, right, noise, 64);
+    bank.store(voices);
+
+    // voice 2 was never started
+    EXPECT_EQ(voices[2].env.level, 0.0f);
+    EXPECT_EQ(voices[2].oscillator.modulation, 1.0f);
+    EXPECT_EQ(voices[2].oscillator.modulationStep, 0.0f);
+    EXPECT_NEAR(voices[0].oscillator.modulation, 0.5f, 1e-6f);
+}
+
+TEST(VoiceBankTests, modulationRampMatchesVoiceRender_test)
+{
+    constexpr int numVoices = 3;
+    auto voices = setupVoices<numVoices>();
+    auto bankVoices = setupVoices<numVoices>();
+
+    VoiceBank<numVoices> bank;
+    bank.load(bankVoices);
+    bank.setModulation(0.9f, 500);
+    for (auto& voice : voices) {
+        if (voice.env.isActive()) {
+            voice.oscillator.modulationStep = (0.9f - voice.oscillator.modulation) * (1.0f / 500.0f);
+            voice.oscillator2.modulationStep = (0.9f - voice.oscillator2.modulation) * (1.0f / 500.0f);
+        }
+    }
+
+    const int numberOfSamples = 500;
+    std::vector<float> noise(numberOfSamples, 0.0f);
+    std::vector<float> left(numberOfSamples), right(numberOfSamples);
+    bank.render(left.data(), right.data(), noise.data(), numberOfSamples);
+    bank.store(bankVoices);
+
+    for (int i = 0; i < numberOfSamples; ++i) {
+        float expectedLeft = 0.0f;
+        for (auto& voice : voices) {
+            if (voice.env.isActive()) {
+                expectedLeft += voice.render(noise[i]) * voice.panLeft;
+            }
+        }
+        EXPECT_NEAR(expectedLeft, left[i], 1e-6f) << i;
+    }
+    EXPECT_EQ(voices[0].oscillator.modulation, bankVoices[0].oscillator.modulation);
+    EXPECT_NEAR(0.9f, bankVoices[0].oscillator.modulation, 1e-4f);
+}
+
+TEST(VoiceBankTests, skipsIdleGroups_test)
+{
+    constexpr int numVoices = 16;
+    auto voices = setupVoices<numVoices>();
+
+    // only voices in the second group are sounding
+    VoiceMask<numVoices> activeVoices;
+    activeVoices.set(9);
+    activeVoices.set(10);
+    for (int i = 0; i < 8; ++i) {
+        voices[i].env.reset();
+    }
+
+    VoiceBank<numVoices> bank;
+    bank.load(voices, activeVoices);
+    VoiceBank<numVoices> fullBank;
+    fullBank.load(voices);
+
+    float noise[64] = {};
+    float left[64], right[64];
+    float fullLeft[64], fullRight[64];
+    bank.render(left, right, noise, 64);
+    fullBank.render(fullLeft, fullRight, noise, 64);
+
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(fullLeft[i], left[i]);
+        EXPECT_EQ(fullRight[i], right[i]);
+    }
+    EXPECT_NE(0.0f, right[63]);
+}
+
+TEST(VoiceBankTests, perVoiceNoise_test)
+{
+    constexpr int numVoices = VoiceBank<8>::LANE_WIDTH;
+    auto voices = setupVoices<numVoices>();
+    auto bankVoices = setupVoices<numVoices>();
+
+    VoiceBank<numVoices> bank;
+    bank.load(bankVoices);
+
+    // a different, changing noise input for every lane
+    const int numberOfSamples = 500;
+    std::vector<float> noise(size_t(numberOfSamples * numVoices));
+    for (size_t i = 0; i < noise.size(); ++i) { noise[i] = 0.001f * float(i % 37); }
+    std::vector<float> left(numberOfSamples), right(numberOfSamples);
+    bank.renderGroup(0, left.data(), right.data(), noise.data(), numberOfSamples, true);
+
+    for (int i = 0; i < numberOfSamples; ++i) {
+        float expectedLeft = 0.0f;
+        float expectedRight = 0.0f;
+        for (int voiceIndex = 0; voiceIndex < numVoices; ++voiceIndex) {
+            Voice& voice = voices[voiceIndex];
+            if (voice.env.isActive()) {
+                const float sample = voice.render(noise[size_t(i * numVoices + voiceIndex)]);
+                expectedLeft += sample * voice.panLeft;
+                expectedRight += sample * voice.panRight;
+            }
+        }
+        EXPECT_NEAR(expectedLeft, left[i], 1e-6f) << i;
+        EXPECT_NEAR(expectedRight, right[i], 1e-6f) << i;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "VoiceMask.h"
+#include <vector>
+
+TEST(VoiceMaskTests, emptyByDefault_test)
+{
+    VoiceMask<8> mask;
+    EXPECT_FALSE(mask.any());
+    EXPECT_EQ(mask.count(), 0);
+    EXPECT_EQ(mask.first(), -1);
+}
+
+TEST(VoiceMaskTests, setAndClear_test)
+{
+    VoiceMask<130> mask;
+    mask.set(3);
+    mask.set(64);
+    mask.set(129);
+    EXPECT_TRUE(mask.test(64));
+    EXPECT_FALSE(mask.test(65));
+    EXPECT_EQ(mask.count(), 3);
+    EXPECT_EQ(mask.first(), 3);
+
+    mask.clear(3);
+    EXPECT_EQ(mask.first(), 64);
+    mask.clearAll();
+    EXPECT_FALSE(mask.any());
+}
+
+TEST(VoiceMaskTests, anyInRange_test)
+{
+    VoiceMask<32> mask;
+    mask.set(12);
+    EXPECT_FALSE(mask.anyInRange(0, 8));
+    EXPECT_TRUE(mask.anyInRange(8, 8));
+    EXPECT_FALSE(mask.anyInRange(16, 8));
+}
+
+TEST(VoiceMaskTests, forEachVisitsInOrder_test)
+{
+    VoiceMask<200> mask;
+    for (int voice : { 150, 2, 70, 63 }) {
+        mask.set(voice);
+    }
+
+    std::vector<int> visited;
+    mask.forEach([&] (int voice) {
+        visited.push_back(voice);
+        mask.clear(voice);
+    });
+
+    EXPECT_EQ(visited, (std::vector<int> { 2, 63, 70, 150 }));
+    EXPECT_FALSE(mask.any());
+}
+
+TEST(VoiceMaskTests, lastClear_test)
+{
+    VoiceMask<70> mask;
+    EXPECT_EQ(mask.lastClear(), 69);
+    for (int voice = 60; voice < 70; ++voice) {
+        mask.set(voice);
+    }
+    EXPECT_EQ(mask.lastClear(), 59);
+    for (int voice = 0; voice < 60; ++voice) {
+        mask.set(voice);
+    }
+    EXPECT_EQ(mask.lastClear(), -1);
+}
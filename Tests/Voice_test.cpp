@@ -84,4 +84,48 @@ TEST(VoiceTests,render_test) {
         EXPECT_GE(testSample, -1.0f);
         EXPECT_LE(testSample, 1.0f);
     };
-}
\ No newline at end of file
+}
+
+TEST(VoiceTests,renderBlock_test) {
+
+    // two identical voices, one rendered per sample and one per block
+    Voice voices[2];
+    for (auto& voice : voices) {
+        voice.reset();
+        voice.note = 64;
+        voice.update();
+        voice.setSampleRate(44100.0f);
+        voice.allocateResources(256);
+        voice.env.setAttack(10.0f);
+        voice.env.setDecay(50.0f);
+        voice.env.setSustain(50.0f);
+        voice.env.setRelease(0.0f);
+        voice.env.attack();
+        voice.oscillator.amplitude = 0.5f;
+        voice.oscillator2.amplitude = 0.25f;
+        voice.oscillator.period = calculatePeriodFromNote(64.0f, 44100.0f);
+        voice.oscillator2.period = calculatePeriodFromNote(71.0f, 44100.0f);
+        voice.filter.setSampleRate(44100.0f);
+        voice.filter.updateCoefficients(1000.0f,0.707f);
+    }
+
+    float input[256];
+    std::fill(std::begin(input), std::end(input), 0.01f);
+    float left[256] = {};
+    float right[256] = {};
+
+    // the block envelope is worked out in closed form, so it can differ in the last bits
+    voices[1].renderBlock(left, right, input, 200);
+    for (int i = 0; i < 200; i++) {
+        const float sample = voices[0].render(input[i]);
+        EXPECT_NEAR(sample * voices[0].panLeft, left[i], 1e-6f);
+        EXPECT_NEAR(sample * voices[0].panRight, right[i], 1e-6f);
+    }
+
+    // after a release the block stops where the envelope goes silent
+    voices[1].noteOff();
+    std::fill(std::begin(left), std::end(left), 0.0f);
+    voices[1].renderBlock(left, right, input, 256);
+    EXPECT_FALSE(voices[1].env.isActive());
+    EXPECT_EQ(0.0f, left[255]);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "WavetableOscillator.h"
+#include "Helpers.h"
+#include <vector>
+
+TEST(WavetableTests, levelsStayBelowNyquist_test)
+{
+    for (float period = 1.0f; period < 30000.0f; period *= 1.01f) {
+        const int level = Wavetable::levelForPeriod(period);
+        // the top level is a sine, which can't be made any duller
+        if (level < Wavetable::NUM_LEVELS - 1) {
+            EXPECT_LE(float(Wavetable::maxHarmonic(level)) / period, 0.5f);
+        }
+        // and the level below it would have aliased
+        if (level > 0) {
+            EXPECT_GT(float(Wavetable::maxHarmonic(level - 1)) / period, 0.5f);
+        }
+    }
+}
+
+TEST(WavetableTests, builtInShapes_test)
+{
+    // away from the jumps, the full band saw and square are close to the ideal shapes
+    const float* saw = Wavetable::saw().getLevel(0);
+    const float* square = Wavetable::square().getLevel(0);
+    const float* triangle = Wavetable::triangle().getLevel(0);
+    for (int n = 64; n < Wavetable::TABLE_SIZE - 64; n += 64) {
+        const float t = float(n) / float(Wavetable::TABLE_SIZE);
+        EXPECT_NEAR(2.0f * t - 1.0f, saw[n], 0.02f);
+        if (std::abs(t - 0.5f) > 0.03f) {
+            EXPECT_NEAR(t < 0.5f ? 1.0f : -1.0f, square[n], 0.03f);
+        }
+    }
+    EXPECT_NEAR(1.0f, triangle[Wavetable::TABLE_SIZE / 4], 0.001f);
+    EXPECT_NEAR(0.0f, triangle[0], 0.001f);
+
+    // the top level is the fundamental alone
+    const float* sine = Wavetable::square().getLevel(Wavetable::NUM_LEVELS - 1);
+    EXPECT_NEAR(4.0f / PI, sine[Wavetable::TABLE_SIZE / 4], 1e-5f);
+}
+
+TEST(WavetableTests, sharedTables_test)
+{
+    WavetableOscillator osc1;
+    WavetableOscillator osc2;
+    EXPECT_EQ(osc1.wavetable, osc2.wavetable);
+    EXPECT_EQ(&Wavetable::saw(), osc1.wavetable);
+}
+
+TEST(WavetableTests, renderBlockMatchesNextSample_test)
+{
+    WavetableOscillator osc;
+    osc.reset();
+    osc.wavetable = &Wavetable::square();
+    osc.amplitude = 0.5f;
+    osc.period = calculatePeriod(60.0f, 44100.0f);
+    WavetableOscillator blockOsc = osc;
+
+    std::vector<float> block(300);
+    blockOsc.renderBlock(block.data(), 100);
+    blockOsc.renderBlock(block.data() + 100, 200);
+    for (const float sample : block) {
+        EXPECT_NEAR(osc.nextSample(), sample, 1e-3f);
+    }
+}